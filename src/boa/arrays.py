@@ -0,0 +1,118 @@
+"""Packed storage for `[i]` and `[f]` lists.
+
+A Boa list is a Python list of boxed objects: about 36 bytes per integer
+element and 32 per float. A binding annotated `[i]` or `[f]` (an assignment or
+a parameter) instead stores a `TypedArray` over a contiguous int64/float64
+`array.array`, at 8 bytes per element, whenever its value is a list whose
+elements all have exactly that type. Lists are immutable in Boa, so a packed
+array only has to read like one: `len`, `~`, iteration, equality, ordering,
+`+`/`*` and `out` give the same results, and operations that would mix in
+elements of another type produce an ordinary list again.
+"""
+
+from __future__ import annotations
+
+from array import array
+from typing import Any, Iterator
+
+# Element typecode of each packed annotation.
+TYPECODES = {"[i]": "q", "[f]": "d"}
+# PACK instruction args, indexes into this tuple.
+PACKED_TYPES = tuple(TYPECODES)
+_ELEMENT = {"q": int, "d": float}
+
+
+class TypedArray:
+    __slots__ = ("data",)
+
+    __hash__ = None  # type: ignore[assignment]
+
+    def __init__(self, data: array) -> None:
+        self.data = data
+
+    @property
+    def typecode(self) -> str:
+        return self.data.typecode
+
+    def tolist(self) -> list[Any]:
+        return self.data.tolist()
+
+    def __len__(self) -> int:
+        return len(self.data)
+
+    def __iter__(self) -> Iterator[Any]:
+        return iter(self.data)
+
+    def __contains__(self, item: Any) -> bool:
+        return item in self.data
+
+    def __getitem__(self, index: int | slice) -> Any:
+        if isinstance(index, slice):
+            return TypedArray(self.data[index])
+        return self.data[index]
+
+    def __eq__(self, other: Any) -> bool:
+        if type(other) is TypedArray:
+            return self.data == other.data
+        if type(other) is list:
+            return len(other) == len(self.data) and self.data.tolist() == other
+        return NotImplemented
+
+    def __lt__(self, other: Any) -> bool:
+        return self.data.tolist() < _plain(other)
+
+    def __le__(self, other: Any) -> bool:
+        return self.data.tolist() <= _plain(other)
+
+    def __gt__(self, other: Any) -> bool:
+        return self.data.tolist() > _plain(other)
+
+    def __ge__(self, other: Any) -> bool:
+        return self.data.tolist() >= _plain(other)
+
+    def __add__(self, other: Any) -> Any:
+        packed = _like(self.data.typecode, other)
+        if packed is not None:
+            return TypedArray(self.data + packed)
+        return self.data.tolist() + _plain(other)
+
+    def __radd__(self, other: Any) -> Any:
+        packed = _like(self.data.typecode, other)
+        if packed is not None:
+            return TypedArray(packed + self.data)
+        return _plain(other) + self.data.tolist()
+
+    def __mul__(self, count: Any) -> Any:
+        if type(count) is int:
+            return TypedArray(self.data * count)
+        return self.data.tolist() * count
+
+    __rmul__ = __mul__
+
+    def __repr__(self) -> str:
+        return repr(self.data.tolist())
+
+
+def _plain(value: Any) -> Any:
+    return value.data.tolist() if type(value) is TypedArray else value
+
+
+def _like(typecode: str, value: Any) -> array | None:
+    """`value` as an array of `typecode`, or None when it is not a list of such elements."""
+    if type(value) is TypedArray:
+        return value.data if value.data.typecode == typecode else None
+    if type(value) is not list or not set(map(type, value)) <= {_ELEMENT[typecode]}:
+        return None
+    try:
+        return array(typecode, value)
+    except OverflowError:
+        return None
+
+
+def pack(value: Any, annotation: str) -> Any:
+    """`value` as bound to a name annotated `annotation` (a key of TYPECODES)."""
+    if type(value) is list:
+        data = _like(TYPECODES[annotation], value)
+        if data is not None:
+            return TypedArray(data)
+    return value
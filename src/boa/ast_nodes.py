@@ -1,148 +1,288 @@
-"""AST node definitions for the Boa language."""
+"""AST node definitions for the Boa language.
+
+Nodes are slotted, frozen dataclasses. Each carries its 1-based source
+position in trailing `line` and `column` fields that take no part in
+equality; line 0 means the node was synthesized and has no position. The
+parser hands every node the line number object its tokens share and columns
+are small ints, so positions allocate nothing per node; `span` packs one into
+a single int for the position tables of errors and bytecode.
+"""
 
 from __future__ import annotations
 
-from dataclasses import dataclass
+from dataclasses import dataclass, field
+
+
+# Low bits of a span hold the column, clamped; the rest the line.
+COLUMN_BITS = 10
+COLUMN_MASK = (1 << COLUMN_BITS) - 1
+
+
+def pack_span(line: int, column: int) -> int:
+    return (line << COLUMN_BITS) | min(column, COLUMN_MASK)
+
+
+def span_line(span: int) -> int:
+    return span >> COLUMN_BITS
+
+
+def span_column(span: int) -> int:
+    return span & COLUMN_MASK
 
 
-@dataclass(frozen=True)
+@dataclass(frozen=True, slots=True)
 class Program:
     statements: list[Stmt]
 
 
-class Stmt:
-    pass
+class Node:
+    __slots__ = ()
+    line: int
+    column: int
 
+    @property
+    def span(self) -> int:
+        return pack_span(self.line, self.column)
 
-class Expr:
-    pass
 
+class Stmt(Node):
+    # A statement's position is that of its first token.
+    __slots__ = ()
 
-@dataclass(frozen=True)
+
+class Expr(Node):
+    # An expression's position is the token that performs it: the operator of a
+    # unary or binary expression, the `(` of a call, the name of an attribute.
+    __slots__ = ()
+
+
+@dataclass(frozen=True, slots=True)
 class UseStmt(Stmt):
     module: str
     names: list[str] | None = None
+    line: int = field(default=0, compare=False, repr=False)
+    column: int = field(default=0, compare=False, repr=False)
 
 
-@dataclass(frozen=True)
+@dataclass(frozen=True, slots=True)
 class Param:
     name: str
     annotation: str | None = None
 
 
-@dataclass(frozen=True)
+@dataclass(frozen=True, slots=True)
 class FunctionDef(Stmt):
     name: str
     params: list[Param]
     return_annotation: str | None
     body: list[Stmt]
+    # `afn`: calling it returns a coroutine instead of running the body.
+    is_async: bool = False
+    # `memo fn`: results are cached per argument tuple (see `memo`).
+    memo: bool = False
+    line: int = field(default=0, compare=False, repr=False)
+    column: int = field(default=0, compare=False, repr=False)
 
 
-@dataclass(frozen=True)
+@dataclass(frozen=True, slots=True)
 class ClassDef(Stmt):
     name: str
     base_name: str | None
     body: list[Stmt]
+    line: int = field(default=0, compare=False, repr=False)
+    column: int = field(default=0, compare=False, repr=False)
 
 
-@dataclass(frozen=True)
+@dataclass(frozen=True, slots=True)
 class ReturnStmt(Stmt):
     value: Expr | None
+    line: int = field(default=0, compare=False, repr=False)
+    column: int = field(default=0, compare=False, repr=False)
 
 
-@dataclass(frozen=True)
+@dataclass(frozen=True, slots=True)
 class AssignStmt(Stmt):
     name: str
     annotation: str | None
     value: Expr
+    line: int = field(default=0, compare=False, repr=False)
+    column: int = field(default=0, compare=False, repr=False)
 
 
-@dataclass(frozen=True)
+@dataclass(frozen=True, slots=True)
+class AttrAssignStmt(Stmt):
+    target: Expr
+    name: str
+    value: Expr
+    line: int = field(default=0, compare=False, repr=False)
+    column: int = field(default=0, compare=False, repr=False)
+
+
+@dataclass(frozen=True, slots=True)
 class ExprStmt(Stmt):
     expr: Expr
+    line: int = field(default=0, compare=False, repr=False)
+    column: int = field(default=0, compare=False, repr=False)
 
 
-@dataclass(frozen=True)
+@dataclass(frozen=True, slots=True)
 class OutStmt(Stmt):
     expr: Expr
+    line: int = field(default=0, compare=False, repr=False)
+    column: int = field(default=0, compare=False, repr=False)
 
 
-@dataclass(frozen=True)
+@dataclass(frozen=True, slots=True)
 class IfStmt(Stmt):
     condition: Expr
     body: list[Stmt]
     elif_blocks: list[tuple[Expr, list[Stmt]]]
     else_body: list[Stmt] | None
+    line: int = field(default=0, compare=False, repr=False)
+    column: int = field(default=0, compare=False, repr=False)
 
 
-@dataclass(frozen=True)
+@dataclass(frozen=True, slots=True)
 class ForStmt(Stmt):
     var_name: str
     iterable: Expr
     body: list[Stmt]
+    # `pfor`: iterations run on worker processes (see `parallel`).
+    parallel: bool = False
+    line: int = field(default=0, compare=False, repr=False)
+    column: int = field(default=0, compare=False, repr=False)
 
 
-@dataclass(frozen=True)
+@dataclass(frozen=True, slots=True)
+class WhileStmt(Stmt):
+    condition: Expr
+    body: list[Stmt]
+    line: int = field(default=0, compare=False, repr=False)
+    column: int = field(default=0, compare=False, repr=False)
+
+
+@dataclass(frozen=True, slots=True)
+class BreakStmt(Stmt):
+    line: int = field(default=0, compare=False, repr=False)
+    column: int = field(default=0, compare=False, repr=False)
+
+
+@dataclass(frozen=True, slots=True)
+class ContinueStmt(Stmt):
+    line: int = field(default=0, compare=False, repr=False)
+    column: int = field(default=0, compare=False, repr=False)
+
+
+@dataclass(frozen=True, slots=True)
 class PassStmt(Stmt):
-    pass
+    line: int = field(default=0, compare=False, repr=False)
+    column: int = field(default=0, compare=False, repr=False)
 
 
-@dataclass(frozen=True)
+@dataclass(frozen=True, slots=True)
 class NameExpr(Expr):
     name: str
+    line: int = field(default=0, compare=False, repr=False)
+    column: int = field(default=0, compare=False, repr=False)
 
 
-@dataclass(frozen=True)
+@dataclass(frozen=True, slots=True)
 class NumberExpr(Expr):
     value: int | float
+    line: int = field(default=0, compare=False, repr=False)
+    column: int = field(default=0, compare=False, repr=False)
 
 
-@dataclass(frozen=True)
+@dataclass(frozen=True, slots=True)
 class StringExpr(Expr):
     value: str
-    is_fstring: bool = False
+    line: int = field(default=0, compare=False, repr=False)
+    column: int = field(default=0, compare=False, repr=False)
+
+
+@dataclass(frozen=True, slots=True)
+class FStringExpr(Expr):
+    # Literal text and interpolated expressions, in source order.
+    parts: list[str | Expr]
+    line: int = field(default=0, compare=False, repr=False)
+    column: int = field(default=0, compare=False, repr=False)
 
 
-@dataclass(frozen=True)
+@dataclass(frozen=True, slots=True)
 class BoolExpr(Expr):
     value: bool
+    line: int = field(default=0, compare=False, repr=False)
+    column: int = field(default=0, compare=False, repr=False)
 
 
-@dataclass(frozen=True)
+@dataclass(frozen=True, slots=True)
 class NilExpr(Expr):
-    pass
+    line: int = field(default=0, compare=False, repr=False)
+    column: int = field(default=0, compare=False, repr=False)
 
 
-@dataclass(frozen=True)
+@dataclass(frozen=True, slots=True)
 class ListExpr(Expr):
     elements: list[Expr]
+    line: int = field(default=0, compare=False, repr=False)
+    column: int = field(default=0, compare=False, repr=False)
 
 
-@dataclass(frozen=True)
+@dataclass(frozen=True, slots=True)
 class DictExpr(Expr):
     entries: list[tuple[Expr, Expr]]
+    line: int = field(default=0, compare=False, repr=False)
+    column: int = field(default=0, compare=False, repr=False)
 
 
-@dataclass(frozen=True)
+@dataclass(frozen=True, slots=True)
 class UnaryExpr(Expr):
     op: str
     expr: Expr
+    line: int = field(default=0, compare=False, repr=False)
+    column: int = field(default=0, compare=False, repr=False)
 
 
-@dataclass(frozen=True)
+@dataclass(frozen=True, slots=True)
+class AwaitExpr(Expr):
+    expr: Expr
+    line: int = field(default=0, compare=False, repr=False)
+    column: int = field(default=0, compare=False, repr=False)
+
+
+@dataclass(frozen=True, slots=True)
 class BinaryExpr(Expr):
     left: Expr
     op: str
     right: Expr
+    line: int = field(default=0, compare=False, repr=False)
+    column: int = field(default=0, compare=False, repr=False)
 
 
-@dataclass(frozen=True)
+@dataclass(frozen=True, slots=True)
 class CallExpr(Expr):
     func: Expr
     args: list[Expr]
+    line: int = field(default=0, compare=False, repr=False)
+    column: int = field(default=0, compare=False, repr=False)
 
 
-@dataclass(frozen=True)
+@dataclass(frozen=True, slots=True)
 class AttrExpr(Expr):
     target: Expr
     name: str
+    line: int = field(default=0, compare=False, repr=False)
+    column: int = field(default=0, compare=False, repr=False)
+
+
+@dataclass(frozen=True, slots=True)
+class SuperCallExpr(Expr):
+    """`super().name(args)`: call the base class's `name` on the method's receiver."""
+
+    name: str
+    args: list[Expr]
+    # First parameter of the method the call is directly in, when that
+    # method's class has a base; otherwise None, which `semantic` rejects.
+    receiver: str | None
+    line: int = field(default=0, compare=False, repr=False)
+    column: int = field(default=0, compare=False, repr=False)
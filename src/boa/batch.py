@@ -0,0 +1,127 @@
+"""`check` and `build` over many files in one command.
+
+`expand_sources` turns the files, directories and glob patterns given on the
+command line into `.boa` paths; `check_files`/`build_files` process them on
+a pool of worker processes and return one `FileResult` per file, in path
+order, so a whole tree is validated by a single invocation.
+
+Unchanged files are skipped by content: `check` consults the compile cache,
+which only ever holds programs that passed (see `cache`), and `build` leaves
+an artifact alone when its bytes already match, so their mtimes only move
+when the output really changes.
+"""
+
+from __future__ import annotations
+
+from concurrent.futures import ProcessPoolExecutor
+from dataclasses import dataclass
+from functools import partial
+import glob
+import os
+from pathlib import Path
+from typing import Callable
+
+from .compiler import build_file, check_file
+from .errors import BoaError
+from .optimizer import DEFAULT_LEVEL
+
+SOURCE_SUFFIX = ".boa"
+
+OK = "ok"
+UNCHANGED = "unchanged"
+FAILED = "failed"
+
+# Everything a bad source file can raise; anything else is a Boa bug and
+# should surface with its traceback.
+_DIAGNOSTICS = (BoaError, ValueError, OSError, RecursionError)
+
+
+@dataclass(frozen=True)
+class FileResult:
+    path: str
+    status: str
+    message: str = ""
+
+
+def default_jobs() -> int:
+    return os.cpu_count() or 1
+
+
+def expand_sources(targets: list[str]) -> list[Path]:
+    """The `.boa` files named by `targets`: files, directories (searched recursively) or globs."""
+    found: dict[Path, None] = {}
+    for target in targets:
+        path = Path(target)
+        if path.is_dir():
+            matches = sorted(path.rglob("*" + SOURCE_SUFFIX))
+        elif path.exists():
+            matches = [path]
+        elif any(ch in target for ch in "*?["):
+            matches = sorted(
+                Path(match)
+                for match in glob.glob(target, recursive=True)
+                if match.endswith(SOURCE_SUFFIX) and os.path.isfile(match)
+            )
+        else:
+            raise FileNotFoundError(f"File not found: {target}")
+        if not matches:
+            raise FileNotFoundError(f"No {SOURCE_SUFFIX} files match {target}")
+        found.update(dict.fromkeys(matches))
+    return list(found)
+
+
+def _check_one(path: str, *, use_cache: bool) -> FileResult:
+    try:
+        checked = check_file(path, use_cache=use_cache)
+    except _DIAGNOSTICS as exc:
+        return FileResult(path, FAILED, str(exc))
+    return FileResult(path, OK if checked else UNCHANGED)
+
+
+def _build_one(path: str, *, opt_level: int, use_cache: bool, native_code: bool) -> FileResult:
+    try:
+        written = build_file(
+            path, Path(path).with_suffix(".boac"), opt_level, use_cache=use_cache, native_code=native_code
+        )
+    except _DIAGNOSTICS as exc:
+        return FileResult(path, FAILED, str(exc))
+    return FileResult(path, OK if written else UNCHANGED)
+
+
+def _map(worker: Callable[[str], FileResult], paths: list[Path], jobs: int) -> list[FileResult]:
+    names = [str(path) for path in paths]
+    if jobs <= 1 or len(names) <= 1:
+        return [worker(name) for name in names]
+    jobs = min(jobs, len(names))
+    # A few chunks per worker balance uneven files without paying one
+    # round-trip per file.
+    chunksize = max(1, len(names) // (jobs * 4))
+    with ProcessPoolExecutor(max_workers=jobs) as pool:
+        return list(pool.map(worker, names, chunksize=chunksize))
+
+
+def check_files(paths: list[Path], *, jobs: int = 1, use_cache: bool = True) -> list[FileResult]:
+    return _map(partial(_check_one, use_cache=use_cache), paths, jobs)
+
+
+def build_files(
+    paths: list[Path],
+    *,
+    jobs: int = 1,
+    opt_level: int = DEFAULT_LEVEL,
+    use_cache: bool = True,
+    native_code: bool = False,
+) -> list[FileResult]:
+    """Build each path into the `.boac` next to it (and its native library with `native_code`)."""
+    worker = partial(_build_one, opt_level=opt_level, use_cache=use_cache, native_code=native_code)
+    return _map(worker, paths, jobs)
+
+
+def format_summary(results: list[FileResult], verb: str) -> str:
+    counts = {status: 0 for status in (OK, UNCHANGED, FAILED)}
+    for result in results:
+        counts[result.status] += 1
+    return (
+        f"{verb} {len(results)} file(s): {counts[OK]} ok, "
+        f"{counts[UNCHANGED]} unchanged, {counts[FAILED]} failed"
+    )
@@ -0,0 +1,212 @@
+"""Performance measurements for the Boa toolchain.
+
+`run_suite` times each benchmark program phase by phase (lex, parse,
+analyze, compile, execute) and reports the best of `repeat` runs per phase,
+work units per second and peak traced memory. A benchmark declares its
+logical work in a header comment such as `# bench: ops=200000`; that figure
+divided by the execute time is the reported ops/sec. Peak memory comes from a
+separate `tracemalloc` pass so tracing never skews the timings.
+"""
+
+from __future__ import annotations
+
+import contextlib
+import io
+from pathlib import Path
+import platform
+import re
+import time
+import tracemalloc
+from typing import Any
+
+from . import __version__
+from .bytecode import compile_program
+from .lexer import iter_tokens, tokenize
+from .optimizer import optimize
+from .parser import parse_tokens
+from .runtime import eval_program
+from .semantic import analyze
+from .vm import run_code
+
+PHASES = ("lex", "parse", "analyze", "compile", "execute")
+
+_OPS_HEADER = re.compile(r"#\s*bench:\s*ops\s*=\s*(\d+)")
+
+
+def _best_of(repeat: int, func: Any) -> tuple[float, Any]:
+    best = float("inf")
+    result = None
+    for _ in range(max(1, repeat)):
+        start = time.perf_counter()
+        result = func()
+        best = min(best, time.perf_counter() - start)
+    return best, result
+
+
+def _peak_bytes(func: Any) -> int:
+    tracemalloc.start()
+    try:
+        func()
+        return tracemalloc.get_traced_memory()[1]
+    finally:
+        tracemalloc.stop()
+
+
+def _count(tokens: Any) -> int:
+    count = 0
+    for _ in tokens:
+        count += 1
+    return count
+
+
+def bench_lex(path: str | Path, repeat: int = 5) -> dict[str, Any]:
+    """Time the streaming tokenizer on `path` and compare it with eager `tokenize`."""
+    source = Path(path).read_text(encoding="utf-8")
+    size = len(source.encode("utf-8"))
+    stream_s, tokens = _best_of(repeat, lambda: _count(iter_tokens(source)))
+    eager_s, _ = _best_of(repeat, lambda: len(tokenize(source)))
+    return {
+        "file": str(path),
+        "bytes": size,
+        "tokens": tokens,
+        "stream_seconds": stream_s,
+        "eager_seconds": eager_s,
+        "tokens_per_second": tokens / stream_s if stream_s else 0.0,
+        "mb_per_second": size / 1e6 / stream_s if stream_s else 0.0,
+        "stream_peak_bytes": _peak_bytes(lambda: _count(iter_tokens(source))),
+        "eager_peak_bytes": _peak_bytes(lambda: tokenize(source)),
+    }
+
+
+def format_lex_report(report: dict[str, Any]) -> str:
+    return "\n".join(
+        [
+            f"lex {report['file']}: {report['tokens']} tokens, {report['bytes']} bytes",
+            f"  streaming  {report['stream_seconds'] * 1000:9.2f} ms"
+            f"  {report['tokens_per_second']:,.0f} tok/s  {report['mb_per_second']:.2f} MB/s"
+            f"  peak {report['stream_peak_bytes'] / 1e6:.2f} MB",
+            f"  eager list {report['eager_seconds'] * 1000:9.2f} ms"
+            f"  peak {report['eager_peak_bytes'] / 1e6:.2f} MB",
+        ]
+    )
+
+
+def default_suite_dir() -> Path:
+    local = Path.cwd() / "benchmarks"
+    if local.is_dir():
+        return local
+    return Path(__file__).resolve().parents[2] / "benchmarks"
+
+
+def discover(targets: list[str | Path]) -> list[Path]:
+    found: list[Path] = []
+    for target in targets or [default_suite_dir()]:
+        path = Path(target)
+        if path.is_dir():
+            found.extend(sorted(path.glob("*.boa")))
+        else:
+            found.append(path)
+    return found
+
+
+def synthetic_source(functions: int = 5000) -> str:
+    """A large generated program for the parse-heavy benchmark."""
+    lines: list[str] = []
+    for idx in range(functions):
+        lines.append(f"fn rule_{idx}(code: i, name: s) -> s:")
+        lines.append(f"    limit: i = {idx} * 60 + 7")
+        lines.append(f'    if code >= limit && name != "n{idx}" || !no:')
+        lines.append(f'        ret f"hit {{name}} at {{limit}}"  # rule {idx}')
+        lines.append('    ret "miss"')
+        lines.append("")
+    lines.append(f'out rule_{functions - 1}(1, "x")')
+    return "\n".join(lines) + "\n"
+
+
+def _pipeline(source: str, engine: str) -> dict[str, Any]:
+    """Run every phase once and return the elapsed seconds of each."""
+    timings: dict[str, Any] = {}
+    clock = time.perf_counter
+
+    start = clock()
+    tokens = tokenize(source)
+    timings["lex"] = clock() - start
+
+    start = clock()
+    program = parse_tokens(tokens)
+    timings["parse"] = clock() - start
+
+    start = clock()
+    analyze(program)
+    timings["analyze"] = clock() - start
+
+    # The default-level optimizer pass counts as compile time on both engines.
+    start = clock()
+    program = optimize(program)
+    code = compile_program(program) if engine == "vm" else None
+    timings["compile"] = clock() - start
+
+    with contextlib.redirect_stdout(io.StringIO()):
+        start = clock()
+        if code is not None:
+            run_code(code)
+        else:
+            eval_program(program)
+        timings["execute"] = clock() - start
+    return timings
+
+
+def bench_program(name: str, source: str, *, engine: str = "vm", repeat: int = 3) -> dict[str, Any]:
+    best = {phase: float("inf") for phase in PHASES}
+    for _ in range(max(1, repeat)):
+        for phase, seconds in _pipeline(source, engine).items():
+            best[phase] = min(best[phase], seconds)
+
+    match = _OPS_HEADER.search(source)
+    ops = int(match.group(1)) if match else 0
+    execute = best["execute"]
+    return {
+        "name": name,
+        "engine": engine,
+        "phases": best,
+        "total_seconds": sum(best.values()),
+        "ops": ops,
+        "ops_per_second": ops / execute if ops and execute else 0.0,
+        "peak_bytes": _peak_bytes(lambda: _pipeline(source, engine)),
+    }
+
+
+def run_suite(
+    targets: list[str | Path],
+    *,
+    engine: str = "vm",
+    repeat: int = 3,
+    include_large_parse: bool = True,
+) -> dict[str, Any]:
+    results = [
+        bench_program(path.stem, path.read_text(encoding="utf-8"), engine=engine, repeat=repeat)
+        for path in discover(targets)
+    ]
+    if include_large_parse:
+        results.append(bench_program("large_parse", synthetic_source(), engine=engine, repeat=repeat))
+    return {
+        "boa_version": __version__,
+        "python": platform.python_version(),
+        "engine": engine,
+        "repeat": repeat,
+        "benchmarks": results,
+    }
+
+
+def format_suite_report(report: dict[str, Any]) -> str:
+    header = f"{'benchmark':<18}" + "".join(f"{p:>10}" for p in PHASES) + f"{'ops/s':>14}{'peak MB':>10}"
+    lines = [
+        f"boa {report['boa_version']} ({report['engine']} engine, python {report['python']}, "
+        f"best of {report['repeat']}; times in ms)",
+        header,
+    ]
+    for result in report["benchmarks"]:
+        phases = "".join(f"{result['phases'][p] * 1000:>10.2f}" for p in PHASES)
+        rate = f"{result['ops_per_second']:>14,.0f}" if result["ops"] else f"{'-':>14}"
+        lines.append(f"{result['name']:<18}{phases}{rate}{result['peak_bytes'] / 1e6:>10.2f}")
+    return "\n".join(lines)
@@ -0,0 +1,321 @@
+"""Binary `.boac` container for compiled Boa bytecode.
+
+Layout (all integers little-endian)::
+
+    header    magic "BOAC", u16 format version, u16 optimization level
+    strings   u32 count, u32[count] byte lengths, utf-8 blob
+    consts    u32 count, u8[count] tags, i64[count] operands
+    code      u32 count, then per code object:
+                u32 name, u32 flags (bit 0: `afn`, bit 1: `memo fn`), u32 nparams, u32[nparams] params,
+                u32 ninstr, u8[ninstr] ops, u32[ninstr] args,
+                u32 nconsts, u32[nconsts] pool refs,
+                u32 nnames, u32[nnames] names,
+                u32 nvarnames, u32[nvarnames] local slot names,
+                u32 nderefs*3, u32[nderefs*3] (depth, slot, name) triples,
+                u32 nspans*2, u32[nspans*2] (first pc, packed position) pairs
+    classes   u32 count, then per class:
+                u32 name, u32 base (NONE_REF if absent),
+                u32 nmethods, u32[nmethods] code refs,
+                u32 nfields, u32[nfields] instance layout field names
+
+Strings are interned once for the whole unit and constants live in a single
+pool, so repeated identifiers and literals cost one entry each. Loading is a
+handful of `array.frombytes` calls per section with no lexing or parsing.
+Code object 0 is the module body.
+"""
+
+from __future__ import annotations
+
+from array import array
+import struct
+import sys
+from typing import Any
+
+from .bytecode import ClassCode, CodeObject, const_key
+from .errors import BoaError
+
+MAGIC = b"BOAC"
+FORMAT_VERSION = 12
+NONE_REF = 0xFFFFFFFF
+_FLAG_ASYNC = 1
+_FLAG_MEMO = 2
+
+_TAG_NIL = 0
+_TAG_TRUE = 1
+_TAG_FALSE = 2
+_TAG_INT = 3
+_TAG_BIGINT = 4
+_TAG_FLOAT = 5
+_TAG_STR = 6
+_TAG_CODE = 7
+_TAG_CLASS = 8
+
+_HEADER = struct.Struct("<4sHH")
+_U32 = struct.Struct("<I")
+_F64 = struct.Struct("<d")
+_I64 = struct.Struct("<q")
+_I64_MIN = -(1 << 63)
+_I64_MAX = (1 << 63) - 1
+_SWAP = sys.byteorder != "little"
+
+
+class BoacError(BoaError):
+    """Raised when a `.boac` artifact is malformed or from another format version."""
+
+
+def is_boac(data: bytes) -> bool:
+    return data[:4] == MAGIC
+
+
+def _le_bytes(values: array) -> bytes:
+    if _SWAP:
+        values = array(values.typecode, values)
+        values.byteswap()
+    return values.tobytes()
+
+
+class _Writer:
+    def __init__(self) -> None:
+        self.strings: list[str] = []
+        self._string_index: dict[str, int] = {}
+        self.tags = array("B")
+        self.operands = array("q")
+        self._const_index: dict[tuple[type, Any], int] = {}
+        self.codes: list[CodeObject] = []
+        self._code_index: dict[int, int] = {}
+        self.classes: list[ClassCode] = []
+        self._class_index: dict[int, int] = {}
+
+    def string(self, value: str) -> int:
+        idx = self._string_index.get(value)
+        if idx is None:
+            idx = len(self.strings)
+            self.strings.append(value)
+            self._string_index[value] = idx
+        return idx
+
+    def code(self, code: CodeObject) -> int:
+        idx = self._code_index.get(id(code))
+        if idx is None:
+            idx = len(self.codes)
+            self.codes.append(code)
+            self._code_index[id(code)] = idx
+            for const in code.constants:
+                self.const(const)
+        return idx
+
+    def klass(self, spec: ClassCode) -> int:
+        idx = self._class_index.get(id(spec))
+        if idx is None:
+            idx = len(self.classes)
+            self.classes.append(spec)
+            self._class_index[id(spec)] = idx
+            for method in spec.methods:
+                self.code(method)
+        return idx
+
+    def const(self, value: Any) -> int:
+        key = (type(value), id(value)) if isinstance(value, (CodeObject, ClassCode)) else const_key(value)
+        idx = self._const_index.get(key)
+        if idx is not None:
+            return idx
+        if value is None:
+            tag, operand = _TAG_NIL, 0
+        elif value is True:
+            tag, operand = _TAG_TRUE, 0
+        elif value is False:
+            tag, operand = _TAG_FALSE, 0
+        elif isinstance(value, int):
+            if _I64_MIN <= value <= _I64_MAX:
+                tag, operand = _TAG_INT, value
+            else:
+                tag, operand = _TAG_BIGINT, self.string(str(value))
+        elif isinstance(value, float):
+            tag, operand = _TAG_FLOAT, _I64.unpack(_F64.pack(value))[0]
+        elif isinstance(value, str):
+            tag, operand = _TAG_STR, self.string(value)
+        elif isinstance(value, CodeObject):
+            tag, operand = _TAG_CODE, self.code(value)
+        elif isinstance(value, ClassCode):
+            tag, operand = _TAG_CLASS, self.klass(value)
+        else:
+            raise BoacError(f"Cannot serialize constant of type {type(value).__name__}")
+        idx = len(self.tags)
+        self.tags.append(tag)
+        self.operands.append(operand)
+        self._const_index[key] = idx
+        return idx
+
+    def _u32s(self, values: list[int]) -> bytes:
+        return _U32.pack(len(values)) + _le_bytes(array("I", values))
+
+    def finish(self, opt_level: int = 0) -> bytes:
+        # Code/class sections reference strings and constants, so encode them
+        # first; the header and pool sections are assembled afterwards.
+        code_parts: list[bytes] = []
+        idx = 0
+        while idx < len(self.codes):
+            code = self.codes[idx]
+            code_parts.append(_U32.pack(self.string(code.name)))
+            flags = (_FLAG_ASYNC if code.is_async else 0) | (_FLAG_MEMO if code.memo else 0)
+            code_parts.append(_U32.pack(flags))
+            code_parts.append(self._u32s([self.string(p) for p in code.params]))
+            ops = array("B", [op for op, _ in code.instructions])
+            args = array("I", [arg for _, arg in code.instructions])
+            code_parts.append(_U32.pack(len(ops)) + ops.tobytes() + _le_bytes(args))
+            code_parts.append(self._u32s([self.const(c) for c in code.constants]))
+            code_parts.append(self._u32s([self.string(n) for n in code.names]))
+            code_parts.append(self._u32s([self.string(n) for n in code.varnames]))
+            triples = [v for d, slot, n in code.derefs for v in (d, slot, self.string(n))]
+            code_parts.append(self._u32s(triples))
+            code_parts.append(self._u32s([v for pair in code.spans for v in pair]))
+            idx += 1
+        code_parts.insert(0, _U32.pack(len(self.codes)))
+
+        class_parts: list[bytes] = [_U32.pack(len(self.classes))]
+        for spec in self.classes:
+            base = NONE_REF if spec.base_name is None else self.string(spec.base_name)
+            class_parts.append(_U32.pack(self.string(spec.name)) + _U32.pack(base))
+            class_parts.append(self._u32s([self.code(m) for m in spec.methods]))
+            class_parts.append(self._u32s([self.string(f) for f in spec.fields]))
+
+        encoded = [s.encode("utf-8") for s in self.strings]
+        parts = [
+            _HEADER.pack(MAGIC, FORMAT_VERSION, opt_level),
+            self._u32s([len(e) for e in encoded]),
+            b"".join(encoded),
+            _U32.pack(len(self.tags)),
+            self.tags.tobytes(),
+            _le_bytes(self.operands),
+        ]
+        return b"".join(parts + code_parts + class_parts)
+
+
+def dumps(code: CodeObject, *, opt_level: int = 0) -> bytes:
+    writer = _Writer()
+    writer.code(code)
+    return writer.finish(opt_level)
+
+
+def opt_level(data: bytes) -> int:
+    """The `-O` level the artifact `data` was compiled with."""
+    if len(data) < _HEADER.size or not is_boac(data):
+        raise BoacError("Not a .boac artifact (bad magic)")
+    return _HEADER.unpack_from(data, 0)[2]
+
+
+class _Reader:
+    def __init__(self, data: bytes) -> None:
+        self.data = memoryview(data)
+        self.pos = 0
+
+    def u32(self) -> int:
+        value = _U32.unpack_from(self.data, self.pos)[0]
+        self.pos += 4
+        return value
+
+    def array(self, typecode: str, count: int) -> array:
+        values = array(typecode)
+        size = values.itemsize * count
+        if self.pos + size > len(self.data):
+            raise BoacError("Truncated .boac artifact")
+        values.frombytes(self.data[self.pos : self.pos + size])
+        if _SWAP and values.itemsize > 1:
+            values.byteswap()
+        self.pos += size
+        return values
+
+    def u32s(self) -> array:
+        return self.array("I", self.u32())
+
+
+def loads(data: bytes) -> CodeObject:
+    if len(data) < _HEADER.size or not is_boac(data):
+        raise BoacError("Not a .boac artifact (bad magic)")
+    _, version, _ = _HEADER.unpack_from(data, 0)
+    if version != FORMAT_VERSION:
+        raise BoacError(
+            f"Unsupported .boac format version {version} (this Boa reads version {FORMAT_VERSION}); rebuild it"
+        )
+    reader = _Reader(data)
+    reader.pos = _HEADER.size
+
+    try:
+        lengths = reader.u32s()
+        blob = bytes(reader.data[reader.pos : reader.pos + sum(lengths)])
+        reader.pos += len(blob)
+        strings: list[str] = []
+        offset = 0
+        for length in lengths:
+            strings.append(blob[offset : offset + length].decode("utf-8"))
+            offset += length
+
+        nconsts = reader.u32()
+        tags = reader.array("B", nconsts)
+        operands = reader.array("q", nconsts)
+
+        codes: list[CodeObject] = []
+        code_consts: list[array] = []
+        for _ in range(reader.u32()):
+            name = strings[reader.u32()]
+            flags = reader.u32()
+            params = [strings[i] for i in reader.u32s()]
+            ninstr = reader.u32()
+            ops = reader.array("B", ninstr)
+            args = reader.array("I", ninstr)
+            code = CodeObject(
+                name,
+                params,
+                list(zip(ops, args)),
+                is_async=bool(flags & _FLAG_ASYNC),
+                memo=bool(flags & _FLAG_MEMO),
+            )
+            code_consts.append(reader.u32s())
+            code.names = [strings[i] for i in reader.u32s()]
+            code.varnames = [strings[i] for i in reader.u32s()]
+            triples = reader.u32s()
+            code.derefs = [
+                (triples[i], triples[i + 1], strings[triples[i + 2]]) for i in range(0, len(triples), 3)
+            ]
+            pairs = reader.u32s()
+            code.spans = list(zip(pairs[::2], pairs[1::2]))
+            codes.append(code)
+
+        classes: list[ClassCode] = []
+        for _ in range(reader.u32()):
+            name = strings[reader.u32()]
+            base = reader.u32()
+            methods = [codes[i] for i in reader.u32s()]
+            fields = [strings[i] for i in reader.u32s()]
+            classes.append(ClassCode(name, None if base == NONE_REF else strings[base], methods, fields))
+    except (IndexError, struct.error, UnicodeDecodeError) as exc:
+        raise BoacError("Corrupt .boac artifact") from exc
+
+    pool: list[Any] = []
+    for tag, operand in zip(tags, operands):
+        if tag == _TAG_INT:
+            pool.append(operand)
+        elif tag == _TAG_STR:
+            pool.append(strings[operand])
+        elif tag == _TAG_NIL:
+            pool.append(None)
+        elif tag == _TAG_TRUE:
+            pool.append(True)
+        elif tag == _TAG_FALSE:
+            pool.append(False)
+        elif tag == _TAG_FLOAT:
+            pool.append(_F64.unpack(_I64.pack(operand))[0])
+        elif tag == _TAG_BIGINT:
+            pool.append(int(strings[operand]))
+        elif tag == _TAG_CODE:
+            pool.append(codes[operand])
+        elif tag == _TAG_CLASS:
+            pool.append(classes[operand])
+        else:
+            raise BoacError(f"Unknown constant tag {tag}")
+
+    for code, refs in zip(codes, code_consts):
+        code.constants = [pool[i] for i in refs]
+    if not codes:
+        raise BoacError("Empty .boac artifact")
+    return codes[0]
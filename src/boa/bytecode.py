@@ -0,0 +1,697 @@
+"""Bytecode compiler targeting the Boa virtual machine."""
+
+from __future__ import annotations
+
+from bisect import bisect_right
+from dataclasses import dataclass, field
+import math
+import operator
+from typing import Any
+
+from .ast_nodes import (
+    AssignStmt,
+    AttrAssignStmt,
+    AttrExpr,
+    AwaitExpr,
+    BinaryExpr,
+    BoolExpr,
+    BreakStmt,
+    CallExpr,
+    ClassDef,
+    ContinueStmt,
+    DictExpr,
+    Expr,
+    ExprStmt,
+    ForStmt,
+    FStringExpr,
+    FunctionDef,
+    IfStmt,
+    ListExpr,
+    NameExpr,
+    NilExpr,
+    NumberExpr,
+    OutStmt,
+    PassStmt,
+    Program,
+    ReturnStmt,
+    StringExpr,
+    SuperCallExpr,
+    UnaryExpr,
+    UseStmt,
+    WhileStmt,
+)
+from .arrays import PACKED_TYPES, TYPECODES
+from .scopes import DEREF, FAST, FunctionScope, instance_layout, resolve_scopes
+
+
+# Opcodes. Numbering follows rough execution frequency so the VM dispatch
+# chain can test the hottest instructions first.
+LOAD_FAST = 0
+LOAD_CONST = 1
+STORE_FAST = 2
+BINARY_OP = 3
+POP_JUMP_IF_FALSE = 4
+JUMP = 5
+FOR_ITER = 6
+CALL = 7
+RETURN_VALUE = 8
+LOAD_GLOBAL = 9
+STORE_GLOBAL = 10
+LOAD_DEREF = 11
+POP_TOP = 12
+LOAD_ATTR = 13
+OUT = 14
+UNARY_NEG = 15
+UNARY_NOT = 16
+TO_BOOL = 17
+GET_ITER = 18
+BUILD_LIST = 19
+BUILD_DICT = 20
+BUILD_STRING = 21
+FORMAT_VALUE = 22
+MAKE_FUNCTION = 23
+# Pops the base class first when the class has one (`ClassCode.base_name`).
+MAKE_CLASS = 24
+LOAD_METHOD = 25
+CALL_METHOD = 26
+STORE_ATTR = 27
+# Compare-and-branch for a condition that is a comparison: the arg packs the
+# jump target above the low four bits, which index BINARY_OPS, so `if a < b:`
+# runs as one instruction instead of BINARY_OP plus POP_JUMP_IF_FALSE. It
+# applies the same operator, so it needs no knowledge of the operand types.
+COMPARE_JUMP = 28
+# `for v ~ range(...)` with a local loop variable: advances the range iterator
+# and stores straight into the variable's slot (the low FOR_RANGE_SHIFT bits of
+# the arg), jumping to the exit target in the high bits once it is exhausted.
+FOR_RANGE = 29
+# `ret f(...)`: like CALL, but the callee's frame replaces the caller's, so a
+# chain of tail calls runs in constant depth. Always followed by RETURN_VALUE,
+# which hands back the result when the call could not replace the frame.
+TAIL_CALL = 30
+# `aw`: suspends the coroutine frame on the awaitable at the top of the stack;
+# the awaited result is pushed when the frame resumes (see `VM._coroutine`).
+AWAIT = 31
+# `use`: pushes the module named by arg, resolved by `runtime.import_module`.
+USE_MODULE = 32
+# Emitted only by profiling builds (`compile_program(..., profile=True)`), so
+# ordinary programs never reach these branches.
+PROFILE_ENTER = 33
+PROFILE_EXIT = 34
+PROFILE_LINE = 35
+# Rebinds the value at the top of the stack as the packed array the annotation
+# `arrays.PACKED_TYPES[arg]` asks for (see `arrays.pack`).
+PACK = 36
+# `pfor`: pops the iterable and runs the loop that follows on workers, each
+# executing it over one chunk of the items in a frame of its own (see
+# `VM._pfor`), then jumps to arg. The loop exits to PAR_END, which ends such a
+# worker frame; the frame that ran PFOR never reaches it.
+PFOR = 37
+PAR_END = 38
+# Ahead of each RETURN_VALUE of a `memo fn`: records the value at the top of
+# the stack as the call's result under the `(cache, key)` the VM put in local
+# slot arg when it entered the frame (see `_frame_for` in `vm`).
+MEMO_STORE = 39
+# Pushes the base class method named by arg for `super().name(...)`, whose
+# receiver and arguments follow for CALL_METHOD. MAKE_CLASS appends the base
+# as the last cell of a subclass's method closures, so resolving it takes no
+# search (see `VM._execute`).
+LOAD_SUPER = 40
+
+OPNAMES = {
+    value: name
+    for name, value in dict(globals()).items()
+    if name.isupper() and isinstance(value, int)
+}
+
+
+def _contains(left: Any, right: Any) -> bool:
+    return left in right
+
+
+def _not_contains(left: Any, right: Any) -> bool:
+    return left not in right
+
+
+# Binary operators are encoded as an index into this table so the VM does
+# one opcode test plus a C-level call instead of a string-compare chain.
+BINARY_OPS: list[tuple[str, Any]] = [
+    ("+", operator.add),
+    ("-", operator.sub),
+    ("*", operator.mul),
+    ("/", operator.truediv),
+    ("%", operator.mod),
+    ("==", operator.eq),
+    ("!=", operator.ne),
+    ("<", operator.lt),
+    (">", operator.gt),
+    ("<=", operator.le),
+    (">=", operator.ge),
+    ("==:", operator.is_),
+    ("!==:", operator.is_not),
+    ("~", _contains),
+    ("!~", _not_contains),
+]
+
+BINARY_INDEX = {symbol: idx for idx, (symbol, _) in enumerate(BINARY_OPS)}
+BINARY_FUNCS = [func for _, func in BINARY_OPS]
+
+_COMPARE_BRANCH = {"==", "!=", "<", ">", "<=", ">=", "==:", "!==:", "~", "!~"}
+COMPARE_JUMP_SHIFT = 4
+COMPARE_JUMP_MASK = (1 << COMPARE_JUMP_SHIFT) - 1
+FOR_RANGE_SHIFT = 16
+FOR_RANGE_MASK = (1 << FOR_RANGE_SHIFT) - 1
+# Farthest exit target a FOR_RANGE arg can hold in a .boac's u32 args.
+FOR_RANGE_MAX_TARGET = (1 << (32 - FOR_RANGE_SHIFT)) - 1
+# Jumps whose arg carries an operand below the target.
+_PACKED_JUMPS = {COMPARE_JUMP: COMPARE_JUMP_SHIFT, FOR_RANGE: FOR_RANGE_SHIFT}
+
+
+_first_pc = operator.itemgetter(0)
+
+
+class CompileError(ValueError):
+    pass
+
+
+@dataclass
+class CodeObject:
+    name: str
+    params: list[str]
+    instructions: list[tuple[int, int]] = field(default_factory=list)
+    constants: list[Any] = field(default_factory=list)
+    names: list[str] = field(default_factory=list)
+    # Local slot names, parameters first; `len(varnames)` is the frame size.
+    varnames: list[str] = field(default_factory=list)
+    # `(depth, slot, name)` of each enclosing-function variable LOAD_DEREF reads.
+    derefs: list[tuple[int, int, str]] = field(default_factory=list)
+    # Inline caches of the attribute instructions, keyed by pc and filled by
+    # the VM at run time (see `runtime.resolve_member`); never serialized.
+    sites: dict[int, list[Any]] = field(default_factory=dict, compare=False, repr=False)
+    # Compiled from an `afn`: calling it creates a coroutine.
+    is_async: bool = False
+    # Compiled from a `memo fn`; its last local slot holds the call's memo entry.
+    memo: bool = False
+    # `(first pc, span)` runs: every instruction from `first pc` up to the
+    # next run came from the source position `span` (see `ast_nodes.pack_span`).
+    spans: list[tuple[int, int]] = field(default_factory=list)
+    # Native implementation bound by `native.attach` when an artifact with a
+    # `--native` library is loaded; never serialized.
+    native: Any = field(default=None, compare=False, repr=False)
+
+    def span_at(self, pc: int) -> int:
+        """The packed source position of instruction `pc`, or 0 if unknown."""
+        at = bisect_right(self.spans, pc, key=_first_pc) - 1
+        return self.spans[at][1] if at >= 0 else 0
+
+
+@dataclass
+class ClassCode:
+    name: str
+    base_name: str | None
+    methods: list[CodeObject]
+    # Instance layout: the fields `__init__` assigns, in slot order.
+    fields: list[str] = field(default_factory=list)
+
+
+def const_key(value: Any) -> tuple[Any, ...]:
+    """Key under which equal constants share one pool entry.
+
+    Values only share an entry when they are interchangeable: `1`, `1.0` and
+    `yes` compare equal but differ in type, and `0.0 == -0.0` but the sign
+    shows in the output, so a float's key keeps its sign.
+    """
+    if type(value) is float:
+        return float, value, math.copysign(1.0, value)
+    return type(value), value
+
+
+class _CodeBuilder:
+    def __init__(
+        self,
+        name: str,
+        params: list[str],
+        scope: FunctionScope | None,
+        scopes: dict[int, FunctionScope],
+        profile: bool = False,
+    ) -> None:
+        self.code = CodeObject(name, params)
+        self.scope = scope
+        self.scopes = scopes
+        self.profile = profile
+        # One `(continue target, break jumps to patch)` per enclosing loop.
+        self.loops: list[tuple[int, list[int]]] = []
+        if scope is not None:
+            self.code.varnames = scope.varnames
+        self._const_index: dict[tuple[type, Any], int] = {}
+        self._name_index: dict[str, int] = {}
+        self._deref_index: dict[str, int] = {}
+        # Position of the node being compiled; `emit` records where it changes.
+        self.span = 0
+        # Slot of a `memo fn`'s memo entry, which every return records into.
+        self.memo_slot: int | None = None
+
+    def emit(self, op: int, arg: int = 0) -> int:
+        code = self.code
+        pc = len(code.instructions)
+        if self.span and (not code.spans or code.spans[-1][1] != self.span):
+            code.spans.append((pc, self.span))
+        code.instructions.append((op, arg))
+        return pc
+
+    def patch(self, at: int, target: int) -> None:
+        op, arg = self.code.instructions[at]
+        shift = _PACKED_JUMPS.get(op)
+        if shift is not None:
+            target = (target << shift) | (arg & ((1 << shift) - 1))
+        self.code.instructions[at] = (op, target)
+
+    def here(self) -> int:
+        return len(self.code.instructions)
+
+    def mark(self) -> tuple[int, ...]:
+        code = self.code
+        return (
+            len(code.instructions), len(code.spans), len(code.constants), len(code.names), len(code.derefs), self.span
+        )
+
+    def rewind(self, mark: tuple[int, ...]) -> None:
+        """Drop everything emitted since `mark`, to compile the same code another way."""
+        code = self.code
+        pc, spans, constants, names, derefs, self.span = mark
+        del code.instructions[pc:], code.spans[spans:], code.constants[constants:]
+        del code.names[names:], code.derefs[derefs:]
+        self._const_index = {key: idx for key, idx in self._const_index.items() if idx < constants}
+        self._name_index = {key: idx for key, idx in self._name_index.items() if idx < names}
+        self._deref_index = {key: idx for key, idx in self._deref_index.items() if idx < derefs}
+
+    def const(self, value: Any) -> int:
+        hashable = isinstance(value, (int, float, str, bool)) or value is None
+        if hashable:
+            key = const_key(value)
+            if key in self._const_index:
+                return self._const_index[key]
+        self.code.constants.append(value)
+        idx = len(self.code.constants) - 1
+        if hashable:
+            self._const_index[key] = idx
+        return idx
+
+    def name(self, value: str) -> int:
+        if value not in self._name_index:
+            self.code.names.append(value)
+            self._name_index[value] = len(self.code.names) - 1
+        return self._name_index[value]
+
+    def load(self, name: str) -> None:
+        if self.scope is None:
+            self.emit(LOAD_GLOBAL, self.name(name))
+            return
+        kind, depth, slot = self.scope.lookup(name)
+        if kind == FAST:
+            self.emit(LOAD_FAST, slot)
+        elif kind == DEREF:
+            idx = self._deref_index.get(name)
+            if idx is None:
+                idx = len(self.code.derefs)
+                self.code.derefs.append((depth, slot, name))
+                self._deref_index[name] = idx
+            self.emit(LOAD_DEREF, idx)
+        else:
+            self.emit(LOAD_GLOBAL, self.name(name))
+
+    def ret(self) -> None:
+        if self.profile:
+            self.emit(PROFILE_EXIT)
+        if self.memo_slot is not None:
+            self.emit(MEMO_STORE, self.memo_slot)
+        self.emit(RETURN_VALUE)
+
+    def store(self, name: str) -> None:
+        # Assignment always binds in the innermost function (or the module).
+        if self.scope is None:
+            self.emit(STORE_GLOBAL, self.name(name))
+        else:
+            self.emit(STORE_FAST, self.scope.slots[name])
+
+
+def compile_program(
+    program: Program,
+    scopes: dict[int, FunctionScope] | None = None,
+    *,
+    profile: bool = False,
+) -> CodeObject:
+    """Compile `program`; `profile=True` adds call and line events for the profiler."""
+    if scopes is None:
+        scopes = resolve_scopes(program)
+    builder = _CodeBuilder("<module>", [], None, scopes, profile)
+    _compile_body(builder, program.statements)
+    return builder.code
+
+
+def _compile_function(stmt: FunctionDef, b: _CodeBuilder) -> CodeObject:
+    builder = _CodeBuilder(
+        stmt.name, [p.name for p in stmt.params], b.scopes[id(stmt)], b.scopes, b.profile
+    )
+    builder.code.is_async = stmt.is_async
+    if stmt.memo:
+        builder.code.memo = True
+        builder.memo_slot = len(builder.code.varnames)
+        builder.code.varnames = [*builder.code.varnames, "<memo>"]
+    for slot, param in enumerate(stmt.params):
+        if param.annotation in TYPECODES:
+            builder.emit(LOAD_FAST, slot)
+            builder.emit(PACK, PACKED_TYPES.index(param.annotation))
+            builder.emit(STORE_FAST, slot)
+    _compile_body(builder, stmt.body)
+    return builder.code
+
+
+def _compile_body(b: _CodeBuilder, stmts: list) -> None:
+    if b.profile:
+        b.emit(PROFILE_ENTER)
+    _compile_block(b, stmts)
+    b.emit(LOAD_CONST, b.const(None))
+    b.ret()
+
+
+def _compile_block(b: _CodeBuilder, stmts: list) -> None:
+    for stmt in stmts:
+        _compile_stmt(b, stmt)
+
+
+def _compile_stmt(b: _CodeBuilder, stmt) -> None:
+    if isinstance(stmt, PassStmt):
+        return
+    if stmt.line:
+        b.span = stmt.span
+    if b.profile:
+        b.emit(PROFILE_LINE, stmt.line)
+    if isinstance(stmt, UseStmt):
+        module = b.name(stmt.module)
+        if stmt.names is None:
+            b.emit(USE_MODULE, module)
+            b.store(stmt.module)
+        for name in stmt.names or ():
+            b.emit(USE_MODULE, module)
+            b.emit(LOAD_ATTR, b.name(name))
+            b.store(name)
+        return
+    if isinstance(stmt, FunctionDef):
+        b.emit(MAKE_FUNCTION, b.const(_compile_function(stmt, b)))
+        b.store(stmt.name)
+        return
+    if isinstance(stmt, ClassDef):
+        methods = [
+            _compile_function(child, b) for child in stmt.body if isinstance(child, FunctionDef)
+        ]
+        spec = ClassCode(stmt.name, stmt.base_name, methods, instance_layout(stmt))
+        if stmt.base_name is not None:
+            b.load(stmt.base_name)
+        b.emit(MAKE_CLASS, b.const(spec))
+        b.store(stmt.name)
+        return
+    if isinstance(stmt, ReturnStmt):
+        if stmt.value is None:
+            b.emit(LOAD_CONST, b.const(None))
+        elif isinstance(stmt.value, CallExpr) and not b.profile and b.memo_slot is None:
+            # Profiling builds keep every frame so PROFILE_EXIT pairs up, and
+            # a `memo fn` keeps its own to record the result.
+            call = stmt.value
+            _compile_expr(b, call.func)
+            for arg in call.args:
+                _compile_expr(b, arg)
+            if call.line:
+                b.span = call.span
+            b.emit(TAIL_CALL, len(call.args))
+        else:
+            _compile_expr(b, stmt.value)
+        b.ret()
+        return
+    if isinstance(stmt, AssignStmt):
+        _compile_expr(b, stmt.value)
+        if stmt.annotation in TYPECODES:
+            b.emit(PACK, PACKED_TYPES.index(stmt.annotation))
+        b.store(stmt.name)
+        return
+    if isinstance(stmt, AttrAssignStmt):
+        _compile_expr(b, stmt.value)
+        _compile_expr(b, stmt.target)
+        b.emit(STORE_ATTR, b.name(stmt.name))
+        return
+    if isinstance(stmt, ExprStmt):
+        _compile_expr(b, stmt.expr)
+        b.emit(POP_TOP)
+        return
+    if isinstance(stmt, OutStmt):
+        _compile_expr(b, stmt.expr)
+        b.emit(OUT)
+        return
+    if isinstance(stmt, IfStmt):
+        end_jumps: list[int] = []
+        branches = [(stmt.condition, stmt.body), *stmt.elif_blocks]
+        for cond, body in branches:
+            skip = _compile_branch(b, cond)
+            _compile_block(b, body)
+            end_jumps.append(b.emit(JUMP))
+            b.patch(skip, b.here())
+        if stmt.else_body is not None:
+            _compile_block(b, stmt.else_body)
+        for at in end_jumps:
+            b.patch(at, b.here())
+        return
+    if isinstance(stmt, ForStmt):
+        slot = _range_loop_slot(b, stmt)
+        if slot is not None:
+            start = b.mark()
+            if _compile_for(b, stmt, slot) <= FOR_RANGE_MAX_TARGET:
+                return
+            # The loop ends too far away for FOR_RANGE's arg to reach.
+            b.rewind(start)
+        _compile_for(b, stmt, None)
+        return
+    if isinstance(stmt, WhileStmt):
+        top = b.here()
+        exit_jump = _compile_branch(b, stmt.condition)
+        for at in _compile_loop_body(b, top, stmt.body):
+            b.patch(at, b.here())
+        b.patch(exit_jump, b.here())
+        return
+    if isinstance(stmt, BreakStmt):
+        b.loops[-1][1].append(b.emit(JUMP))
+        return
+    if isinstance(stmt, ContinueStmt):
+        b.emit(JUMP, b.loops[-1][0])
+        return
+
+    raise CompileError(f"Unsupported statement {type(stmt).__name__}")
+
+
+def _compile_for(b: _CodeBuilder, stmt: ForStmt, slot: int | None) -> int:
+    """Compile `stmt`, as a FOR_RANGE loop over local `slot` unless it is None; returns its exit target."""
+    _compile_expr(b, stmt.iterable)
+    par = b.emit(PFOR) if stmt.parallel else None
+    if par is None:
+        b.emit(GET_ITER)
+    top = b.here()
+    if slot is not None:
+        exit_jump = b.emit(FOR_RANGE, slot)
+    else:
+        exit_jump = b.emit(FOR_ITER)
+        b.store(stmt.var_name)
+    breaks = _compile_loop_body(b, top, stmt.body)
+    if breaks:
+        # A `break` leaves the iterator on the stack; exhaustion pops it.
+        for at in breaks:
+            b.patch(at, b.here())
+        b.emit(POP_TOP)
+    exit_target = b.here()
+    b.patch(exit_jump, exit_target)
+    if par is not None:
+        b.emit(PAR_END)
+        b.patch(par, b.here())
+    return exit_target
+
+
+def _compile_loop_body(b: _CodeBuilder, top: int, body: list) -> list[int]:
+    """Compile a loop body ending in a jump back to `top`; returns its `break` jumps."""
+    breaks: list[int] = []
+    b.loops.append((top, breaks))
+    _compile_block(b, body)
+    b.loops.pop()
+    b.emit(JUMP, top)
+    return breaks
+
+
+def _range_loop_slot(b: _CodeBuilder, stmt: ForStmt) -> int | None:
+    """The loop variable's slot if `stmt` can run as a FOR_RANGE loop."""
+    if b.scope is None:
+        return None
+    iterable = stmt.iterable
+    if not (isinstance(iterable, CallExpr) and isinstance(iterable.func, NameExpr)):
+        return None
+    if iterable.func.name != "range" or b.scope.lookup("range")[0] in (FAST, DEREF):
+        return None
+    slot = b.scope.slots[stmt.var_name]
+    return slot if slot <= FOR_RANGE_MASK else None
+
+
+def _compile_branch(b: _CodeBuilder, cond: Expr) -> int:
+    """Compile `cond` and a jump taken when it is false; returns the jump to patch."""
+    if isinstance(cond, BinaryExpr) and cond.op in _COMPARE_BRANCH:
+        _compile_expr(b, cond.left)
+        _compile_expr(b, cond.right)
+        if cond.line:
+            b.span = cond.span
+        return b.emit(COMPARE_JUMP, BINARY_INDEX[cond.op])
+    _compile_expr(b, cond)
+    return b.emit(POP_JUMP_IF_FALSE)
+
+
+def _compile_expr(b: _CodeBuilder, expr: Expr) -> None:
+    if not expr.line:
+        _emit_expr(b, expr)
+        return
+    # Operands compile under their own positions; the instruction that
+    # applies `expr` is emitted back under its position.
+    outer = b.span
+    b.span = expr.span
+    _emit_expr(b, expr)
+    b.span = outer
+
+
+def _emit_expr(b: _CodeBuilder, expr: Expr) -> None:
+    if isinstance(expr, NameExpr):
+        b.load(expr.name)
+        return
+    if isinstance(expr, (NumberExpr, BoolExpr)):
+        b.emit(LOAD_CONST, b.const(expr.value))
+        return
+    if isinstance(expr, StringExpr):
+        b.emit(LOAD_CONST, b.const(expr.value))
+        return
+    if isinstance(expr, FStringExpr):
+        for part in expr.parts:
+            if isinstance(part, str):
+                b.emit(LOAD_CONST, b.const(part))
+            else:
+                _compile_expr(b, part)
+                b.emit(FORMAT_VALUE)
+        b.emit(BUILD_STRING, len(expr.parts))
+        return
+    if isinstance(expr, NilExpr):
+        b.emit(LOAD_CONST, b.const(None))
+        return
+    if isinstance(expr, ListExpr):
+        for element in expr.elements:
+            _compile_expr(b, element)
+        b.emit(BUILD_LIST, len(expr.elements))
+        return
+    if isinstance(expr, DictExpr):
+        for key, value in expr.entries:
+            _compile_expr(b, key)
+            _compile_expr(b, value)
+        b.emit(BUILD_DICT, len(expr.entries))
+        return
+    if isinstance(expr, AwaitExpr):
+        _compile_expr(b, expr.expr)
+        b.emit(AWAIT)
+        return
+    if isinstance(expr, UnaryExpr):
+        _compile_expr(b, expr.expr)
+        if expr.op == "-":
+            b.emit(UNARY_NEG)
+        elif expr.op == "!":
+            b.emit(UNARY_NOT)
+        else:
+            raise CompileError(f"Unsupported unary operator '{expr.op}'")
+        return
+    if isinstance(expr, BinaryExpr):
+        if expr.op in ("&&", "||"):
+            _compile_logical(b, expr)
+            return
+        if expr.op not in BINARY_INDEX:
+            raise CompileError(f"Unsupported operator '{expr.op}'")
+        _compile_expr(b, expr.left)
+        _compile_expr(b, expr.right)
+        b.emit(BINARY_OP, BINARY_INDEX[expr.op])
+        return
+    if isinstance(expr, AttrExpr):
+        _compile_expr(b, expr.target)
+        b.emit(LOAD_ATTR, b.name(expr.name))
+        return
+    if isinstance(expr, CallExpr):
+        if isinstance(expr.func, AttrExpr):
+            # LOAD_METHOD leaves `function, receiver` on the stack so the call
+            # binds the receiver without allocating a bound-method object.
+            _compile_expr(b, expr.func.target)
+            b.emit(LOAD_METHOD, b.name(expr.func.name))
+            for arg in expr.args:
+                _compile_expr(b, arg)
+            b.emit(CALL_METHOD, len(expr.args))
+            return
+        _compile_expr(b, expr.func)
+        for arg in expr.args:
+            _compile_expr(b, arg)
+        b.emit(CALL, len(expr.args))
+        return
+    if isinstance(expr, SuperCallExpr):
+        if expr.receiver is None:
+            raise CompileError("'super()' used outside a method of a class with a base")
+        b.emit(LOAD_SUPER, b.name(expr.name))
+        b.load(expr.receiver)
+        for arg in expr.args:
+            _compile_expr(b, arg)
+        b.emit(CALL_METHOD, len(expr.args))
+        return
+
+    raise CompileError(f"Unsupported expression {type(expr).__name__}")
+
+
+def _compile_logical(b: _CodeBuilder, expr: BinaryExpr) -> None:
+    # `&&`/`||` always yield a bool, matching the tree-walking runtime.
+    _compile_expr(b, expr.left)
+    if expr.op == "&&":
+        short = b.emit(POP_JUMP_IF_FALSE)
+        _compile_expr(b, expr.right)
+        b.emit(TO_BOOL)
+        done = b.emit(JUMP)
+        b.patch(short, b.here())
+        b.emit(LOAD_CONST, b.const(False))
+    else:
+        b.emit(UNARY_NOT)
+        short = b.emit(POP_JUMP_IF_FALSE)
+        _compile_expr(b, expr.right)
+        b.emit(TO_BOOL)
+        done = b.emit(JUMP)
+        b.patch(short, b.here())
+        b.emit(LOAD_CONST, b.const(True))
+    b.patch(done, b.here())
+
+
+def disassemble(code: CodeObject) -> str:
+    lines = [f"code {code.name}({', '.join(code.params)})"]
+    for pc, (op, arg) in enumerate(code.instructions):
+        detail = ""
+        if op in (LOAD_GLOBAL, STORE_GLOBAL, LOAD_ATTR, LOAD_METHOD, STORE_ATTR, LOAD_SUPER):
+            detail = f" ({code.names[arg]})"
+        elif op in (LOAD_FAST, STORE_FAST):
+            detail = f" ({code.varnames[arg]})"
+        elif op == LOAD_DEREF:
+            depth, slot, name = code.derefs[arg]
+            detail = f" ({name}: depth {depth}, slot {slot})"
+        elif op == LOAD_CONST:
+            detail = f" ({code.constants[arg]!r})"
+        elif op == BINARY_OP:
+            detail = f" ({BINARY_OPS[arg][0]})"
+        elif op == COMPARE_JUMP:
+            kind = BINARY_OPS[arg & COMPARE_JUMP_MASK][0]
+            detail = f" ({kind}, to {arg >> COMPARE_JUMP_SHIFT})"
+        elif op == FOR_RANGE:
+            detail = f" ({code.varnames[arg & FOR_RANGE_MASK]}, to {arg >> FOR_RANGE_SHIFT})"
+        lines.append(f"  {pc:4d} {OPNAMES[op]:<18} {arg}{detail}")
+    for const in code.constants:
+        if isinstance(const, CodeObject):
+            lines.append(disassemble(const))
+        elif isinstance(const, ClassCode):
+            lines.extend(disassemble(method) for method in const.methods)
+    return "\n".join(lines)
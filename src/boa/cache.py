@@ -0,0 +1,92 @@
+"""Content-addressed on-disk cache of compiled Boa programs.
+
+Entries are `.boac` artifacts named by a hash of the source bytes, the Boa
+version, the `.boac` format version and the optimization level, so an edited
+file, a Boa upgrade, a format bump or a different `-O` all miss naturally and
+stale entries are simply never read again.
+Only programs that parsed and passed semantic analysis are stored, which lets
+`check` treat a hit as already validated.
+
+The cache lives in `$BOA_CACHE_DIR` when set, otherwise in the platform user
+cache directory. Setting `BOA_NO_CACHE=1` disables it.
+"""
+
+from __future__ import annotations
+
+import hashlib
+import os
+from pathlib import Path
+import sys
+import tempfile
+
+from . import __version__, boac
+from .bytecode import CodeObject
+from .optimizer import DEFAULT_LEVEL
+
+SUFFIX = ".boac"
+
+
+def enabled() -> bool:
+    return os.environ.get("BOA_NO_CACHE", "") in ("", "0")
+
+
+def cache_dir() -> Path:
+    override = os.environ.get("BOA_CACHE_DIR")
+    if override:
+        return Path(override)
+    if sys.platform.startswith("win"):
+        base = os.environ.get("LOCALAPPDATA") or str(Path.home() / "AppData" / "Local")
+    else:
+        base = os.environ.get("XDG_CACHE_HOME") or str(Path.home() / ".cache")
+    return Path(base) / "boa"
+
+
+def cache_key(source: bytes, opt_level: int = DEFAULT_LEVEL) -> str:
+    digest = hashlib.sha256()
+    digest.update(f"boa {__version__} boac {boac.FORMAT_VERSION} O{opt_level}\0".encode("ascii"))
+    digest.update(source)
+    return digest.hexdigest()
+
+
+def entry_path(source: bytes, opt_level: int = DEFAULT_LEVEL) -> Path:
+    return cache_dir() / (cache_key(source, opt_level) + SUFFIX)
+
+
+def lookup(source: bytes, opt_level: int = DEFAULT_LEVEL) -> CodeObject | None:
+    try:
+        data = entry_path(source, opt_level).read_bytes()
+    except OSError:
+        return None
+    try:
+        return boac.loads(data)
+    except boac.BoacError:
+        return None
+
+
+def store(source: bytes, code: CodeObject, opt_level: int = DEFAULT_LEVEL) -> None:
+    target = entry_path(source, opt_level)
+    try:
+        target.parent.mkdir(parents=True, exist_ok=True)
+        fd, tmp = tempfile.mkstemp(dir=target.parent, suffix=".tmp")
+        try:
+            with os.fdopen(fd, "wb") as handle:
+                handle.write(boac.dumps(code, opt_level=opt_level))
+            os.replace(tmp, target)
+        except BaseException:
+            Path(tmp).unlink(missing_ok=True)
+            raise
+    except OSError:
+        # A read-only or full cache must never break `run`/`check`.
+        return
+
+
+def clear() -> int:
+    root = cache_dir()
+    if not root.is_dir():
+        return 0
+    removed = 0
+    for entry in root.iterdir():
+        if entry.suffix in (SUFFIX, ".tmp") and entry.is_file():
+            entry.unlink(missing_ok=True)
+            removed += 1
+    return removed
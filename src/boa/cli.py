@@ -3,37 +3,158 @@
 from __future__ import annotations
 
 import argparse
+import json
+import os
 from pathlib import Path
 import shutil
 import stat
 import sys
+from typing import TYPE_CHECKING
 
-if __package__:
-    from . import __version__
-    from .compiler import build_file, check_file, run_file
-    from .errors import BoaError
-else:  # pragma: no cover - used when executed as a direct script/frozen entrypoint
+if not __package__:  # pragma: no cover - used when executed as a direct script/frozen entrypoint
     src_dir = Path(__file__).resolve().parents[1]
     if str(src_dir) not in sys.path:
         sys.path.insert(0, str(src_dir))
-    from boa import __version__
-    from boa.compiler import build_file, check_file, run_file
-    from boa.errors import BoaError
+
+# Imports are absolute so PyInstaller, which freezes this file as a plain
+# script, can follow them into the package. Only what building the parser
+# needs is imported up front; each command
+# imports the pipeline modules it uses, so `version`, `help` and a `run`
+# forwarded to `boa serve` never load the compiler.
+from boa import __version__
+from boa.defaults import DEFAULT_LEVEL as DEFAULT_OPT_LEVEL, DEFAULT_MAX_STACK, ENGINES, LEVELS as OPT_LEVELS
+from boa.errors import BoaError
+from boa.output import DEFAULT_OUT_BUFFER
+
+if TYPE_CHECKING:
+    from boa.batch import FileResult
+
+
+def _add_opt_level(parser: argparse.ArgumentParser) -> None:
+    parser.add_argument(
+        "-O",
+        dest="opt_level",
+        type=int,
+        choices=OPT_LEVELS,
+        default=DEFAULT_OPT_LEVEL,
+        metavar="LEVEL",
+        help="Optimization level: 0 none, 1 fold constants and dead branches (default), 2 also prune dead code",
+    )
+
+
+def _positive_int(text: str) -> int:
+    value = int(text)
+    if value < 1:
+        raise argparse.ArgumentTypeError(f"expected a positive integer, got {text}")
+    return value
+
+
+def _add_batch_options(parser: argparse.ArgumentParser) -> None:
+    parser.add_argument(
+        "-j",
+        "--jobs",
+        type=_positive_int,
+        metavar="N",
+        help="Worker processes for multiple files (default: one per CPU)",
+    )
+    parser.add_argument("--no-cache", action="store_true", help="Bypass the compile cache")
 
 
 def _build_parser() -> argparse.ArgumentParser:
     parser = argparse.ArgumentParser(prog="boa", description="Boa language CLI")
     sub = parser.add_subparsers(dest="command")
 
-    run_p = sub.add_parser("run", help="Compile and execute a .boa file")
+    run_p = sub.add_parser("run", help="Compile and execute a .boa file or a prebuilt .boac artifact")
     run_p.add_argument("source", type=str)
+    run_p.add_argument(
+        "--engine",
+        choices=ENGINES,
+        default="vm",
+        help="Execution engine: bytecode VM (default) or the reference tree-walker",
+    )
+    run_p.add_argument("--no-cache", action="store_true", help="Bypass the compile cache")
+    _add_opt_level(run_p)
+    run_p.add_argument(
+        "--max-stack",
+        type=_positive_int,
+        default=DEFAULT_MAX_STACK,
+        metavar="N",
+        help=f"Maximum Boa call depth; tail calls do not count (default: {DEFAULT_MAX_STACK})",
+    )
+    run_p.add_argument(
+        "--out-buffer",
+        type=_positive_int,
+        default=DEFAULT_OUT_BUFFER,
+        metavar="CHARS",
+        help=f"Characters of `out` output to collect before writing them (default: {DEFAULT_OUT_BUFFER})",
+    )
+    run_p.add_argument(
+        "--unbuffered",
+        action="store_true",
+        help="Write and flush every `out` line as soon as it is printed",
+    )
+    run_p.add_argument(
+        "--mem-stats",
+        action="store_true",
+        help="Print the peak call depth, frame and instance allocations and peak traced memory to stderr",
+    )
+    run_p.add_argument(
+        "--profile",
+        action="store_true",
+        help="Print phase, function and line timings to stderr and write collapsed stacks",
+    )
+    run_p.add_argument(
+        "--profile-stacks",
+        type=str,
+        help="Collapsed-stack output for flame graphs (default: <source>.collapsed)",
+    )
+
+    build_p = sub.add_parser(
+        "build",
+        help="Compile .boa files into binary .boac artifacts (`build SOURCE OUTPUT` for one file)",
+    )
+    build_p.add_argument("sources", nargs="+", help="Files, directories or glob patterns")
+    build_p.add_argument(
+        "-o",
+        "--output",
+        type=str,
+        help="Artifact path when building a single source (default: next to it, as .boac)",
+    )
+    _add_opt_level(build_p)
+    _add_batch_options(build_p)
+    build_p.add_argument(
+        "--native",
+        action="store_true",
+        help="Also compile fully typed functions to a C++ shared library next to each artifact ($CXX)",
+    )
 
-    build_p = sub.add_parser("build", help="Compile a .boa file into .boac JSON IR")
-    build_p.add_argument("source", type=str)
-    build_p.add_argument("output", type=str, nargs="?")
+    check_p = sub.add_parser("check", help="Parse and type-check .boa files")
+    check_p.add_argument("sources", nargs="+", help="Files, directories or glob patterns")
+    _add_batch_options(check_p)
 
-    check_p = sub.add_parser("check", help="Parse and type-check a .boa file")
-    check_p.add_argument("source", type=str)
+    cache_p = sub.add_parser("cache", help="Manage the compile cache")
+    cache_p.add_argument("action", choices=("clear", "dir"))
+
+    bench_p = sub.add_parser(
+        "bench",
+        help="Measure Boa performance (runs the benchmarks/ suite by default)",
+    )
+    bench_sub = bench_p.add_subparsers(dest="bench_command")
+    suite_p = bench_sub.add_parser("suite", help="Time every phase of benchmark programs")
+    suite_p.add_argument("targets", nargs="*", help="Benchmark files or directories (default: benchmarks/)")
+    suite_p.add_argument("--engine", choices=ENGINES, default="vm")
+    suite_p.add_argument("--repeat", type=int, default=3, help="Runs per benchmark; the best is reported")
+    suite_p.add_argument("--json", action="store_true", help="Emit the report as JSON")
+    suite_p.add_argument("--output", type=str, help="Also write the JSON report to this file")
+    suite_p.add_argument(
+        "--no-large-parse",
+        action="store_true",
+        help="Skip the generated large-file parse benchmark",
+    )
+    lex_p = bench_sub.add_parser("lex", help="Measure tokenizer throughput and memory on a file")
+    lex_p.add_argument("source", type=str)
+    lex_p.add_argument("--repeat", type=int, default=5, help="Timed runs; the best is reported")
+    lex_p.add_argument("--json", action="store_true", help="Emit the report as JSON")
 
     install_p = sub.add_parser(
         "install",
@@ -46,34 +167,190 @@ def _build_parser() -> argparse.ArgumentParser:
         help="Overwrite destination if it already exists",
     )
 
+    sub.add_parser("lsp", help="Run a Language Server Protocol server on stdin/stdout")
+    serve_p = sub.add_parser(
+        "serve",
+        help="Keep a warm process that runs `boa run` for any shell with $BOA_SERVER set to its socket",
+    )
+    serve_p.add_argument(
+        "--socket",
+        type=str,
+        help="Unix socket to listen on (default: boa.sock in $XDG_RUNTIME_DIR or the temp directory)",
+    )
     sub.add_parser("version", help="Print Boa version")
     sub.add_parser("help", help="Show usage")
     return parser
 
 
-def _resolve_output(source: Path, output: str | None) -> Path:
-    if output:
-        return Path(output)
-    return source.with_suffix(".boac")
+def _report_failures(results: list[FileResult]) -> int:
+    from boa.batch import FAILED
+
+    failed = [result for result in results if result.status == FAILED]
+    for result in failed:
+        print(f"{result.path}: {result.message}", file=sys.stderr)
+    return 1 if failed else 0
 
 
-def _cmd_build(source: Path, output: Path) -> int:
-    build_file(source, output)
-    print(f"Built {output}")
+def _cmd_build(
+    source: Path,
+    output: Path,
+    opt_level: int = DEFAULT_OPT_LEVEL,
+    *,
+    use_cache: bool = True,
+    native_code: bool = False,
+) -> int:
+    from boa.compiler import build_file
+
+    written = build_file(source, output, opt_level, use_cache=use_cache, native_code=native_code)
+    print(f"Built {output}" if written else f"Up to date: {output}")
+    return 0
+
+
+def _cmd_build_many(
+    targets: list[str],
+    *,
+    jobs: int,
+    opt_level: int = DEFAULT_OPT_LEVEL,
+    use_cache: bool = True,
+    native_code: bool = False,
+) -> int:
+    from boa.batch import UNCHANGED, build_files, expand_sources, format_summary
+
+    results = build_files(
+        expand_sources(targets), jobs=jobs, opt_level=opt_level, use_cache=use_cache, native_code=native_code
+    )
+    status = _report_failures(results)
+    if len(results) == 1 and not status:
+        output = Path(results[0].path).with_suffix(".boac")
+        print(f"Up to date: {output}" if results[0].status == UNCHANGED else f"Built {output}")
+    elif len(results) > 1:
+        print(format_summary(results, "Built"))
+    return status
+
+
+def _cmd_check(targets: list[str], *, jobs: int, use_cache: bool = True) -> int:
+    from boa.batch import check_files, expand_sources, format_summary
+
+    results = check_files(expand_sources(targets), jobs=jobs, use_cache=use_cache)
+    status = _report_failures(results)
+    if len(results) == 1 and not status:
+        print(f"OK: {results[0].path}")
+    elif len(results) > 1:
+        print(format_summary(results, "Checked"))
+    return status
+
+
+def _cmd_run(
+    source: Path,
+    engine: str = "vm",
+    *,
+    use_cache: bool = True,
+    opt_level: int = DEFAULT_OPT_LEVEL,
+    max_stack: int = DEFAULT_MAX_STACK,
+    out_buffer: int = DEFAULT_OUT_BUFFER,
+    mem_stats: bool = False,
+) -> int:
+    from boa.compiler import run_file
+    from boa.runtime import RuntimeErrorBoa
+
+    if mem_stats:
+        import tracemalloc
+
+        from boa.memstats import STATS
+
+        STATS.reset()
+        tracemalloc.start()
+    try:
+        run_file(
+            source, engine, use_cache=use_cache, opt_level=opt_level, max_stack=max_stack, out_buffer=out_buffer
+        )
+    except RuntimeErrorBoa as exc:
+        print(f"{source}: {exc}", file=sys.stderr)
+        return 1
+    finally:
+        if mem_stats:
+            peak_bytes = tracemalloc.get_traced_memory()[1]
+            tracemalloc.stop()
+            print(STATS.report(engine, peak_bytes), file=sys.stderr)
+    return 0
+
+
+def _cmd_profile(source: Path, engine: str, stacks: Path, opt_level: int = DEFAULT_OPT_LEVEL) -> int:
+    from boa.compiler import profile_file
+    from boa.profiler import write_collapsed
+
+    profiler, text = profile_file(source, engine, opt_level)
+    print(profiler.report(text), file=sys.stderr)
+    write_collapsed(profiler, stacks)
+    print(f"Wrote collapsed stacks to {stacks}", file=sys.stderr)
+    return 0
+
+
+def _cmd_cache(action: str) -> int:
+    from boa.cache import cache_dir, clear as clear_cache
+
+    if action == "dir":
+        print(cache_dir())
+        return 0
+    removed = clear_cache()
+    print(f"Removed {removed} cached file(s) from {cache_dir()}")
     return 0
 
 
-def _cmd_check(source: Path) -> int:
-    check_file(source)
-    print(f"OK: {source}")
+def _cmd_bench_lex(source: Path, *, repeat: int, as_json: bool) -> int:
+    from boa.bench import bench_lex, format_lex_report
+
+    report = bench_lex(source, repeat)
+    print(json.dumps(report, indent=2) if as_json else format_lex_report(report))
     return 0
 
 
-def _cmd_run(source: Path) -> int:
-    run_file(source)
+def _cmd_bench_suite(args: argparse.Namespace) -> int:
+    from boa.bench import format_suite_report, run_suite
+
+    report = run_suite(
+        args.targets,
+        engine=args.engine,
+        repeat=args.repeat,
+        include_large_parse=not args.no_large_parse,
+    )
+    if args.output:
+        Path(args.output).write_text(json.dumps(report, indent=2) + "\n", encoding="utf-8")
+    print(json.dumps(report, indent=2) if args.json else format_suite_report(report))
     return 0
 
 
+def _is_source_target(target: str) -> bool:
+    """Whether `target` names `.boa` sources: a `.boa` file, a directory or a glob pattern."""
+    from boa.batch import SOURCE_SUFFIX
+
+    return target.endswith(SOURCE_SUFFIX) or Path(target).is_dir() or any(ch in target for ch in "*?[")
+
+
+def _cmd_batch(args: argparse.Namespace) -> int:
+    from boa.batch import default_jobs
+
+    use_cache = not args.no_cache
+    jobs = args.jobs or default_jobs()
+    if args.command == "check":
+        return _cmd_check(args.sources, jobs=jobs, use_cache=use_cache)
+    sources = args.sources
+    output = args.output
+    if output is None and len(sources) == 2 and not _is_source_target(sources[1]):
+        # `build SOURCE OUTPUT`: a second name that cannot be a source is the artifact.
+        sources, output = sources[:1], sources[1]
+    if output is not None:
+        if len(sources) != 1:
+            raise ValueError("-o/--output needs exactly one source file")
+        source = Path(sources[0])
+        if not source.is_file():
+            raise FileNotFoundError(f"File not found: {source}")
+        return _cmd_build(source, Path(output), args.opt_level, use_cache=use_cache, native_code=args.native)
+    return _cmd_build_many(
+        sources, jobs=jobs, opt_level=args.opt_level, use_cache=use_cache, native_code=args.native
+    )
+
+
 def _current_installable_path() -> Path:
     if getattr(sys, "frozen", False):
         return Path(sys.executable).resolve()
@@ -89,6 +366,19 @@ def _resolve_install_destination(destination: Path, source_name: str) -> Path:
     return destination
 
 
+def _bundle_dir() -> Path | None:
+    """The support directory of a one-dir frozen build, which must be installed beside the executable."""
+    bundle = getattr(sys, "_MEIPASS", None)
+    if not getattr(sys, "frozen", False) or bundle is None:
+        return None
+    bundle_path = Path(bundle).resolve()
+    executable_dir = Path(sys.executable).resolve().parent
+    if bundle_path == executable_dir or not bundle_path.is_relative_to(executable_dir):
+        # A one-file build (unpacked to a temp dir) is self-contained.
+        return None
+    return bundle_path
+
+
 def _cmd_install(destination: Path, *, force: bool = False) -> int:
     source = _current_installable_path()
     target = _resolve_install_destination(destination, source.name)
@@ -108,6 +398,9 @@ def _cmd_install(destination: Path, *, force: bool = False) -> int:
         return 1
 
     shutil.copy2(source, target)
+    bundle = _bundle_dir()
+    if bundle is not None:
+        shutil.copytree(bundle, target.parent / bundle.name, dirs_exist_ok=True)
     if not sys.platform.startswith("win"):
         current_mode = target.stat().st_mode
         if not current_mode & stat.S_IXUSR:
@@ -118,6 +411,15 @@ def _cmd_install(destination: Path, *, force: bool = False) -> int:
 
 
 def main(argv: list[str] | None = None) -> int:
+    argv = sys.argv[1:] if argv is None else argv
+    server = os.environ.get("BOA_SERVER")
+    if server and argv[:1] == ["run"]:
+        from boa.serve import forward
+
+        status = forward(server, argv)
+        if status is not None:
+            return status
+
     parser = _build_parser()
     args = parser.parse_args(argv)
 
@@ -131,19 +433,48 @@ def main(argv: list[str] | None = None) -> int:
     try:
         if args.command == "install":
             return _cmd_install(Path(args.destination), force=args.force)
+        if args.command == "cache":
+            return _cmd_cache(args.action)
+        if args.command == "lsp":
+            from boa.lsp import serve as serve_lsp
+
+            return serve_lsp()
+        if args.command == "serve":
+            from boa.serve import serve
+
+            return serve(args.socket)
+        if args.command == "bench" and args.bench_command != "lex":
+            if args.bench_command is None:
+                args = parser.parse_args(["bench", "suite"])
+            return _cmd_bench_suite(args)
+
+        if args.command in ("build", "check"):
+            try:
+                return _cmd_batch(args)
+            except FileNotFoundError as exc:
+                print(str(exc), file=sys.stderr)
+                return 2
 
         source = Path(args.source)
         if not source.exists():
             print(f"File not found: {source}", file=sys.stderr)
             return 2
 
-        if args.command == "build":
-            output = _resolve_output(source, args.output)
-            return _cmd_build(source, output)
-        if args.command == "check":
-            return _cmd_check(source)
+        if args.command == "run" and (args.profile or args.profile_stacks):
+            stacks = Path(args.profile_stacks) if args.profile_stacks else source.with_suffix(".collapsed")
+            return _cmd_profile(source, args.engine, stacks, args.opt_level)
         if args.command == "run":
-            return _cmd_run(source)
+            return _cmd_run(
+                source,
+                args.engine,
+                use_cache=not args.no_cache,
+                opt_level=args.opt_level,
+                max_stack=args.max_stack,
+                out_buffer=0 if args.unbuffered else args.out_buffer,
+                mem_stats=args.mem_stats,
+            )
+        if args.command == "bench":
+            return _cmd_bench_lex(source, repeat=args.repeat, as_json=args.json)
 
         parser.print_help()
         return 1
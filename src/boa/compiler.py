@@ -2,19 +2,25 @@
 
 from __future__ import annotations
 
-from dataclasses import asdict
-import json
 from pathlib import Path
 
+from . import boac, cache, native
+from .bytecode import CodeObject, compile_program
+from .defaults import ENGINES
+from .modules import ModuleLoader, search_path
+from .optimizer import DEFAULT_LEVEL, optimize
+from .output import DEFAULT_OUT_BUFFER
 from .parser import parse_source
-from .runtime import eval_program
+from .profiler import Profiler, profile_source
+from .runtime import DEFAULT_MAX_STACK, eval_program
 from .semantic import analyze
+from .vm import run_code
 
 
-def compile_source(source: str) -> dict:
+def compile_source(source: str, opt_level: int = DEFAULT_LEVEL) -> CodeObject:
     program = parse_source(source)
     analyze(program)
-    return asdict(program)
+    return compile_program(optimize(program, opt_level))
 
 
 def check_source(source: str) -> None:
@@ -22,23 +28,124 @@ def check_source(source: str) -> None:
     analyze(program)
 
 
-def run_source(source: str) -> None:
+def run_source(
+    source: str,
+    engine: str = "vm",
+    opt_level: int = DEFAULT_LEVEL,
+    max_stack: int = DEFAULT_MAX_STACK,
+    loader: ModuleLoader | None = None,
+    out_buffer: int = DEFAULT_OUT_BUFFER,
+) -> None:
+    """Run `source`; its `use` statements search `loader`'s path (default: the cwd, then `$BOA_PATH`)."""
+    if engine not in ENGINES:
+        raise ValueError(f"Unknown engine '{engine}' (expected one of: {', '.join(ENGINES)})")
+    if loader is None:
+        loader = ModuleLoader(search_path(), engine, opt_level=opt_level, max_stack=max_stack)
     program = parse_source(source)
     analyze(program)
-    eval_program(program)
+    program = optimize(program, opt_level)
+    if engine == "tree":
+        eval_program(program, max_stack=max_stack, loader=loader, out_buffer=out_buffer)
+        return
+    run_code(compile_program(program), max_stack=max_stack, loader=loader, out_buffer=out_buffer)
 
 
-def check_file(path: str | Path) -> None:
-    source = Path(path).read_text(encoding="utf-8")
-    check_source(source)
+def load_code(data: bytes, *, use_cache: bool = True, opt_level: int = DEFAULT_LEVEL) -> CodeObject:
+    """Compile source bytes, reusing the on-disk compile cache when possible."""
+    use_cache = use_cache and cache.enabled()
+    if use_cache:
+        code = cache.lookup(data, opt_level)
+        if code is not None:
+            return code
+    code = compile_source(data.decode("utf-8"), opt_level)
+    if use_cache:
+        cache.store(data, code, opt_level)
+    return code
 
 
-def run_file(path: str | Path) -> None:
-    source = Path(path).read_text(encoding="utf-8")
-    run_source(source)
+def check_file(path: str | Path, *, use_cache: bool = True) -> bool:
+    """Validate `path`; returns False when the cache shows its content already passed."""
+    data = Path(path).read_bytes()
+    if use_cache and cache.enabled():
+        # Only validated programs are cached, so an entry for these exact
+        # bytes means they passed; otherwise compiling through the cache is
+        # the check and records it.
+        if cache.entry_path(data).is_file():
+            return False
+        load_code(data)
+        return True
+    check_source(data.decode("utf-8"))
+    return True
 
 
-def build_file(path: str | Path, output: str | Path) -> None:
-    source = Path(path).read_text(encoding="utf-8")
-    unit = compile_source(source)
-    Path(output).write_text(json.dumps(unit, indent=2), encoding="utf-8")
+def run_file(
+    path: str | Path,
+    engine: str = "vm",
+    *,
+    use_cache: bool = True,
+    opt_level: int = DEFAULT_LEVEL,
+    max_stack: int = DEFAULT_MAX_STACK,
+    out_buffer: int = DEFAULT_OUT_BUFFER,
+) -> None:
+    data = Path(path).read_bytes()
+    loader = ModuleLoader(
+        search_path(path), engine, opt_level=opt_level, use_cache=use_cache, max_stack=max_stack
+    )
+    if boac.is_boac(data):
+        # An artifact runs exactly as built; its level was fixed by `build -O`.
+        if engine != "vm":
+            raise ValueError(f"{path}: .boac artifacts run on the vm engine only")
+        code = boac.loads(data)
+        library = native.library_path(path)
+        if library.is_file():
+            native.attach(code, data, library)
+        run_code(code, max_stack=max_stack, loader=loader, out_buffer=out_buffer)
+        return
+    if engine == "vm":
+        code = load_code(data, use_cache=use_cache, opt_level=opt_level)
+        run_code(code, max_stack=max_stack, loader=loader, out_buffer=out_buffer)
+        return
+    run_source(data.decode("utf-8"), engine, opt_level, max_stack, loader, out_buffer)
+
+
+def profile_file(
+    path: str | Path, engine: str = "vm", opt_level: int = DEFAULT_LEVEL
+) -> tuple[Profiler, str]:
+    """Run `path` once under the profiler; returns the profile and the source text."""
+    if engine not in ENGINES:
+        raise ValueError(f"Unknown engine '{engine}' (expected one of: {', '.join(ENGINES)})")
+    data = Path(path).read_bytes()
+    if boac.is_boac(data):
+        raise ValueError(f"{path}: --profile needs a .boa source file, not a .boac artifact")
+    source = data.decode("utf-8")
+    loader = ModuleLoader(search_path(path), engine, opt_level=opt_level)
+    return profile_source(source, engine, opt_level, loader), source
+
+
+def build_file(
+    path: str | Path,
+    output: str | Path,
+    opt_level: int = DEFAULT_LEVEL,
+    *,
+    use_cache: bool = True,
+    native_code: bool = False,
+) -> bool:
+    """Write the `.boac` artifact of `path`; returns False when `output` was already up to date.
+
+    `native_code=True` also builds the artifact's native library (see `native`).
+    """
+    data = Path(path).read_bytes()
+    code = load_code(data, use_cache=use_cache, opt_level=opt_level)
+    artifact = boac.dumps(code, opt_level=opt_level)
+    output = Path(output)
+    written = False
+    try:
+        current = output.read_bytes()
+    except OSError:
+        current = None
+    if current != artifact:
+        output.write_bytes(artifact)
+        written = True
+    if native_code:
+        written |= native.build_library(data.decode("utf-8"), artifact, native.library_path(output))
+    return written
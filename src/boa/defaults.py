@@ -0,0 +1,15 @@
+"""Choices and defaults of the pipeline's options.
+
+The modules that implement them re-export these; they live here so the CLI
+can build its argument parser without importing the compiler.
+"""
+
+# Execution engines: the bytecode VM and the reference tree-walker.
+ENGINES = ("vm", "tree")
+
+# Optimization levels (see `optimizer`).
+LEVELS = (0, 1, 2)
+DEFAULT_LEVEL = 1
+
+# Boa call depth limit of both engines; `run --max-stack` overrides it.
+DEFAULT_MAX_STACK = 100_000
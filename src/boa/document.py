@@ -0,0 +1,163 @@
+"""Incrementally re-checked source documents, for editors (see `lsp`).
+
+A `Document` keeps its text split into top-level chunks: each starts at a
+line with no indentation and runs up to the next one (`ef`/`else` lines and
+column-0 comments continue the chunk before them). Boa has no line
+continuations and the lexer's indentation stack is empty at every such
+boundary, so each chunk lexes, parses and passes `semantic.check_statement`
+on its own, exactly as it would inside the whole file.
+
+An edit re-splits only the chunks it touched (plus the one before, which a
+dedent can extend), and any chunk whose lines come out unchanged keeps its
+results. A keystroke inside one function therefore re-tokenizes, re-parses
+and re-checks that function alone; the only program-wide step left is the
+duplicate-symbol check over the names each chunk already recorded. Results
+are stored relative to their chunk, so edits above a chunk just shift it.
+"""
+
+from __future__ import annotations
+
+from bisect import bisect_right
+from itertools import accumulate
+from dataclasses import dataclass
+import re
+
+from .parser import parse_source
+from .semantic import SemanticError, check_statement
+
+# The location suffix of lexer and parser errors: "... at 3:7", "... at line 3".
+_LOCATION = re.compile(r" at (?:line )?(\d+)(?::(\d+))?$")
+_CONTINUATIONS = ("ef", "else")
+
+
+@dataclass(frozen=True)
+class Diagnostic:
+    line: int  # 0-based
+    column: int  # 0-based
+    message: str
+
+
+def _starts_chunk(line: str) -> bool:
+    if not line or line[0] in " \t\r" or line[0] == "#":
+        return False
+    word = line.split(None, 1)[0].rstrip(":")
+    return word not in _CONTINUATIONS
+
+
+def _split(lines: list[str]) -> list[list[str]]:
+    chunks: list[list[str]] = []
+    for line in lines:
+        if chunks and not _starts_chunk(line):
+            chunks[-1].append(line)
+        else:
+            chunks.append([line])
+    return chunks
+
+
+class _Chunk:
+    __slots__ = ("lines", "declared", "diagnostics")
+
+    def __init__(self, lines: list[str]) -> None:
+        self.lines = lines
+        # Names declared by the chunk's statements, for the duplicate check.
+        self.declared: list[str] = []
+        # (line, column, message), relative to the chunk's first line.
+        self.diagnostics: list[tuple[int, int, str]] = []
+        try:
+            statements = parse_source(lines).statements
+        except ValueError as exc:
+            message = str(exc)
+            location = _LOCATION.search(message)
+            line = int(location.group(1)) - 1 if location else 0
+            column = int(location.group(2)) - 1 if location and location.group(2) else 0
+            self.diagnostics.append((line, column, _LOCATION.sub("", message)))
+            return
+        for stmt in statements:
+            try:
+                self.declared += check_statement(stmt)
+            except SemanticError as exc:
+                line = (exc.line or stmt.line or 1) - 1
+                self.diagnostics.append((line, 0, str(exc)))
+
+
+class Document:
+    def __init__(self, text: str = "") -> None:
+        self.set_text(text)
+
+    @property
+    def text(self) -> str:
+        return "\n".join(self._lines)
+
+    @property
+    def line_count(self) -> int:
+        return len(self._lines)
+
+    def line(self, index: int) -> str:
+        return self._lines[index] if 0 <= index < len(self._lines) else ""
+
+    def set_text(self, text: str) -> None:
+        self._lines = text.split("\n")
+        self._chunks: list[_Chunk] = []
+        # Line count of each chunk, kept in step with `_chunks`.
+        self._lengths: list[int] = []
+        # Running totals that let `diagnostics` return at once for a clean
+        # document: chunks with diagnostics, how often each name is
+        # declared, and how many names are declared more than once.
+        self._broken = 0
+        self._declared: dict[str, int] = {}
+        self._duplicated = 0
+        self._replace(0, 0, [_Chunk(lines) for lines in _split(self._lines)])
+
+    def edit(self, start_line: int, start_column: int, end_line: int, end_column: int, text: str) -> None:
+        """Replace the text between two 0-based (line, column) positions, as in an LSP change."""
+        lines = self._lines
+        last = len(lines) - 1
+        start_line, end_line = min(start_line, last), min(end_line, last)
+        starts = [0, *accumulate(self._lengths)]
+        # The chunks covering the edited lines, and the one before them.
+        first = max(bisect_right(starts, start_line) - 2, 0)
+        stop = bisect_right(starts, end_line)
+        region_start, region_end = starts[first], starts[stop]
+
+        replacement = (lines[start_line][:start_column] + text + lines[end_line][end_column:]).split("\n")
+        lines[start_line : end_line + 1] = replacement
+        region_end += len(replacement) - (end_line - start_line + 1)
+
+        old = {tuple(chunk.lines): chunk for chunk in self._chunks[first:stop]}
+        fresh = []
+        for chunk_lines in _split(lines[region_start:region_end]):
+            chunk = old.pop(tuple(chunk_lines), None)
+            fresh.append(chunk if chunk is not None else _Chunk(chunk_lines))
+        self._replace(first, stop, fresh)
+
+    def _replace(self, first: int, stop: int, fresh: list[_Chunk]) -> None:
+        for chunk, sign in [(chunk, -1) for chunk in self._chunks[first:stop]] + [(chunk, 1) for chunk in fresh]:
+            self._broken += sign * bool(chunk.diagnostics)
+            for name in chunk.declared:
+                count = self._declared.get(name, 0) + sign
+                if count:
+                    self._declared[name] = count
+                else:
+                    del self._declared[name]
+                # Crossing between one and two declarations, either way.
+                if count == (2 if sign > 0 else 1):
+                    self._duplicated += sign
+        self._chunks[first:stop] = fresh
+        self._lengths[first:stop] = [len(chunk.lines) for chunk in fresh]
+
+    def diagnostics(self) -> list[Diagnostic]:
+        if not self._broken and not self._duplicated:
+            return []
+        found: list[Diagnostic] = []
+        seen: set[str] = set()
+        offset = 0
+        for chunk in self._chunks:
+            for line, column, message in chunk.diagnostics:
+                found.append(Diagnostic(offset + line, column, message))
+            if self._duplicated:
+                for name in chunk.declared:
+                    if name in seen:
+                        found.append(Diagnostic(offset, 0, f"Duplicate symbol '{name}'"))
+                    seen.add(name)
+            offset += len(chunk.lines)
+        return found
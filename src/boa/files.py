@@ -0,0 +1,109 @@
+"""Streaming line input: `lines`, `split` and `field`.
+
+`lines("big.log")` is a lazy iterator over the lines of a file, without their
+line endings, for `for line ~ lines("big.log"):`. A regular file is
+memory-mapped and decoded a block of whole lines at a time, so each line costs
+a slice of one C-level `str.split` rather than a buffered read of its own, and
+memory stays bounded by the block size however large the file is. Anything
+that cannot be mapped (an empty file, a pipe) is read through a large buffer
+instead, and `lines()` with no argument streams stdin the same way. Input is
+UTF-8; undecodable bytes read as U+FFFD rather than failing the whole file.
+
+Boa strings have no methods, so `split(line)` and `field(line, n)` pick lines
+apart. `field(line, 2)` is the third whitespace-separated field and
+`field(line, -1, ",")` the last comma-separated one; it splits only as far as
+that field, never building the list of the others, and is nil when the line
+has fewer fields.
+"""
+
+from __future__ import annotations
+
+import mmap
+import sys
+from typing import Any, Iterator
+
+from .output import STDOUT
+from .runtime import RuntimeErrorBoa
+
+# Bytes decoded at a time from a mapped file; lines longer than this are
+# decoded whole.
+BLOCK_SIZE = 1 << 20
+
+
+def _split_block(text: str) -> list[str]:
+    if "\r" in text:
+        text = text.replace("\r\n", "\n")
+    if text.endswith("\n"):
+        text = text[:-1]
+    return text.split("\n")
+
+
+def _mapped_lines(data: mmap.mmap) -> Iterator[str]:
+    with data:
+        start, size = 0, len(data)
+        while start < size:
+            end = start + BLOCK_SIZE
+            if end >= size:
+                stop = size
+            else:
+                # End the block after its last newline so no line (or UTF-8
+                # sequence) straddles two blocks.
+                stop = data.rfind(b"\n", start, end) + 1 or data.find(b"\n", end) + 1 or size
+            yield from _split_block(data[start:stop].decode("utf-8", "replace"))
+            start = stop
+
+
+def _stream_lines(stream: Any) -> Iterator[str]:
+    with stream:
+        for line in stream:
+            yield line[:-1] if line.endswith("\n") else line
+
+
+def _lines(path: Any = None) -> Iterator[str]:
+    if path is None:
+        STDOUT.flush()
+        return _stream_lines(open(sys.stdin.fileno(), encoding="utf-8", errors="replace", closefd=False))
+    if type(path) is not str:
+        raise RuntimeErrorBoa(f"lines() expects a file path string, got {type(path).__name__}")
+    try:
+        handle = open(path, "rb")
+    except OSError as exc:
+        raise RuntimeErrorBoa(f"lines() cannot open '{path}': {exc.strerror}") from None
+    with handle:
+        try:
+            data = mmap.mmap(handle.fileno(), 0, access=mmap.ACCESS_READ)
+        except (OSError, ValueError):
+            data = None
+    if data is not None:
+        return _mapped_lines(data)
+    return _stream_lines(open(path, encoding="utf-8", errors="replace", buffering=BLOCK_SIZE))
+
+
+def _check_text(name: str, text: Any, sep: Any) -> None:
+    if type(text) is not str:
+        raise RuntimeErrorBoa(f"{name}() expects a string, got {type(text).__name__}")
+    if sep is not None and (type(sep) is not str or not sep):
+        raise RuntimeErrorBoa(f"{name}() separator must be a non-empty string, not {sep!r}")
+
+
+def _split(text: Any, sep: Any = None) -> list[str]:
+    _check_text("split", text, sep)
+    return text.split(sep)
+
+
+def _field(text: Any, index: Any, sep: Any = None) -> str | None:
+    _check_text("field", text, sep)
+    if type(index) is not int:
+        raise RuntimeErrorBoa(f"field() index must be an integer, got {type(index).__name__}")
+    if index >= 0:
+        parts = text.split(sep, index + 1)
+        return parts[index] if index < len(parts) else None
+    parts = text.rsplit(sep, -index)
+    return parts[index] if -index <= len(parts) else None
+
+
+BUILTINS = {
+    "lines": _lines,
+    "split": _split,
+    "field": _field,
+}
@@ -1,20 +1,49 @@
-"""Custom tokenizer for Boa source code."""
+"""Custom tokenizer for Boa source code.
+
+`iter_tokens` is a streaming scanner: it pulls one line at a time from the
+source and yields tokens lazily, so the parser can consume a multi-megabyte
+file without materializing the line list or the full token list. Each line
+body is scanned by a single compiled master regex instead of per-character
+branching. `tokenize` is the eager convenience wrapper.
+"""
 
 from __future__ import annotations
 
-from dataclasses import dataclass
+from collections.abc import Iterable, Iterator
+import re
 
 
-@dataclass(frozen=True)
 class Token:
-    kind: str
-    value: str
-    line: int
-    column: int
+    __slots__ = ("kind", "value", "line", "column")
+
+    def __init__(self, kind: str, value: str, line: int, column: int) -> None:
+        self.kind = kind
+        self.value = value
+        self.line = line
+        self.column = column
+
+    def __eq__(self, other: object) -> bool:
+        if not isinstance(other, Token):
+            return NotImplemented
+        return (self.kind, self.value, self.line, self.column) == (
+            other.kind,
+            other.value,
+            other.line,
+            other.column,
+        )
+
+    def __hash__(self) -> int:
+        return hash((self.kind, self.value, self.line, self.column))
+
+    def __repr__(self) -> str:
+        return f"Token({self.kind!r}, {self.value!r}, {self.line}, {self.column})"
 
 
 KEYWORDS = {
     "fn",
+    "afn",
+    "memo",
+    "aw",
     "ret",
     "cls",
     "use",
@@ -27,6 +56,10 @@ KEYWORDS = {
     "ef",
     "else",
     "for",
+    "pfor",
+    "while",
+    "break",
+    "continue",
     "~",
     "..",
 }
@@ -49,6 +82,43 @@ FOUR_CHAR_OPS = {"!==:"}
 
 SINGLE = set("()[]{}:,.?+-*/%=<>!|")
 
+_SINGLE_OPS = set("+-*/%=<>!|")
+
+
+def _alternation(ops: Iterable[str]) -> str:
+    return "|".join(re.escape(op) for op in sorted(ops, key=len, reverse=True))
+
+
+# Leading blanks are folded into every match, then one alternative per token
+# class. Multi-character operators precede single characters and `f"` precedes
+# identifiers, which preserves the precedence of the per-character rules.
+_TOKEN_RE = re.compile(
+    r"""
+    [ \t\f\v]*(?:
+      (?P<fstr>[fF](?:"(?:[^"\\]|\\.)*"|'(?:[^'\\]|\\.)*'))
+    | (?P<name>[^\W\d]\w*)
+    | (?P<op>{ops})
+    | (?P<single>[{single}])
+    | (?P<num>\d+(?:\.(?!\.)\d*)?)
+    | (?P<str>"(?:[^"\\]|\\.)*"|'(?:[^'\\]|\\.)*')
+    | (?P<comment>\#.*)
+    | (?P<tilde>~)
+    )
+    """.format(
+        ops=_alternation(FOUR_CHAR_OPS | DOUBLE_OPS),
+        single=re.escape("".join(sorted(SINGLE))),
+    ),
+    re.VERBOSE,
+)
+_FSTR = _TOKEN_RE.groupindex["fstr"]
+_NAME = _TOKEN_RE.groupindex["name"]
+_OP = _TOKEN_RE.groupindex["op"]
+_SINGLE = _TOKEN_RE.groupindex["single"]
+_NUM = _TOKEN_RE.groupindex["num"]
+_STR = _TOKEN_RE.groupindex["str"]
+_COMMENT = _TOKEN_RE.groupindex["comment"]
+_ESCAPE_RE = re.compile(r"\\(.)")
+
 
 def _split_indent(line: str) -> tuple[str, str]:
     idx = 0
@@ -64,12 +134,45 @@ def _indent_width(indent: str) -> int:
     return width
 
 
-def tokenize(source: str) -> list[Token]:
-    tokens: list[Token] = []
+def _unquote(literal: str) -> str:
+    body = literal[1:-1]
+    return _ESCAPE_RE.sub(r"\1", body) if "\\" in body else body
+
+
+def _scan_error(raw: str, pos: int, line_num: int) -> ValueError:
+    while raw[pos] in " \t\f\v":
+        pos += 1
+    ch = raw[pos]
+    if ch in ('"', "'") or (ch in "fF" and raw[pos + 1 : pos + 2] in ('"', "'")):
+        return ValueError(f"Unterminated string at line {line_num}")
+    return ValueError(f"Unexpected character '{ch}' at line {line_num}:{pos + 1}")
+
+
+def _iter_lines(source: str) -> Iterator[str]:
+    # Walks the string in place so no second copy of the source is made.
+    start = 0
+    find = source.find
+    while True:
+        end = find("\n", start)
+        if end < 0:
+            if start < len(source):
+                yield source[start:]
+            return
+        yield source[start:end]
+        start = end + 1
+
+
+def iter_tokens(source: str | Iterable[str]) -> Iterator[Token]:
+    """Yield tokens from `source` (a string or any iterable of lines) lazily."""
+    lines = _iter_lines(source) if isinstance(source, str) else source
+    match_at = _TOKEN_RE.match
+    keywords = KEYWORDS
+    single_ops = _SINGLE_OPS
     indent_stack = [0]
+    line_num = 0
 
-    lines = source.splitlines()
     for line_num, raw in enumerate(lines, start=1):
+        raw = raw.rstrip("\r\n")
         indent, body = _split_indent(raw)
         if not body.strip():
             continue
@@ -77,102 +180,48 @@ def tokenize(source: str) -> list[Token]:
         width = _indent_width(indent)
         if width > indent_stack[-1]:
             indent_stack.append(width)
-            tokens.append(Token("INDENT", "", line_num, 1))
+            yield Token("INDENT", "", line_num, 1)
         while width < indent_stack[-1]:
             indent_stack.pop()
-            tokens.append(Token("DEDENT", "", line_num, 1))
+            yield Token("DEDENT", "", line_num, 1)
         if width != indent_stack[-1]:
             raise ValueError(f"Invalid indentation at line {line_num}")
 
-        i = len(indent)
-        while i < len(raw):
-            ch = raw[i]
-            if ch.isspace():
-                i += 1
-                continue
-            if ch == "#":
+        pos = len(indent)
+        end = len(raw.rstrip())
+        while pos < end:
+            m = match_at(raw, pos)
+            if m is None:
+                raise _scan_error(raw, pos, line_num)
+            group = m.lastindex
+            text = m.group(group)
+            pos = m.end()
+            column = pos - len(text) + 1
+            if group == _NAME:
+                yield Token("KEYWORD" if text in keywords else "IDENT", text, line_num, column)
+            elif group == _OP:
+                yield Token("OP", text, line_num, column)
+            elif group == _SINGLE:
+                yield Token("OP" if text in single_ops else "PUNCT", text, line_num, column)
+            elif group == _NUM:
+                yield Token("NUMBER", text, line_num, column)
+            elif group == _STR:
+                yield Token("STRING", _unquote(text), line_num, column)
+            elif group == _FSTR:
+                yield Token("FSTRING", _unquote(text[1:]), line_num, column + 1)
+            elif group == _COMMENT:
                 break
+            else:
+                yield Token("KEYWORD", "~", line_num, column)
 
-            long_op = raw[i : i + 4]
-            if long_op in FOUR_CHAR_OPS:
-                tokens.append(Token("OP", long_op, line_num, i + 1))
-                i += 4
-                continue
-
-            double = raw[i : i + 2]
-            if double in DOUBLE_OPS:
-                tokens.append(Token("OP", double, line_num, i + 1))
-                i += 2
-                continue
-
-            if ch in ('"', "'") or (ch in {"f", "F"} and i + 1 < len(raw) and raw[i + 1] in ('"', "'")):
-                is_f = False
-                quote = ch
-                if ch in {"f", "F"}:
-                    is_f = True
-                    i += 1
-                    quote = raw[i]
-                start = i
-                i += 1
-                value_chars: list[str] = []
-                escaped = False
-                while i < len(raw):
-                    c = raw[i]
-                    if escaped:
-                        value_chars.append(c)
-                        escaped = False
-                    elif c == "\\":
-                        escaped = True
-                    elif c == quote:
-                        break
-                    else:
-                        value_chars.append(c)
-                    i += 1
-                if i >= len(raw) or raw[i] != quote:
-                    raise ValueError(f"Unterminated string at line {line_num}")
-                prefix = "f" if is_f else ""
-                tokens.append(Token("STRING", prefix + "".join(value_chars), line_num, start + 1))
-                i += 1
-                continue
-
-            if ch.isdigit():
-                start = i
-                seen_dot = False
-                while i < len(raw) and (raw[i].isdigit() or (raw[i] == "." and not seen_dot and raw[i : i + 2] != "..")):
-                    if raw[i] == ".":
-                        seen_dot = True
-                    i += 1
-                tokens.append(Token("NUMBER", raw[start:i], line_num, start + 1))
-                continue
-
-            if ch.isalpha() or ch == "_":
-                start = i
-                i += 1
-                while i < len(raw) and (raw[i].isalnum() or raw[i] == "_"):
-                    i += 1
-                value = raw[start:i]
-                kind = "KEYWORD" if value in KEYWORDS else "IDENT"
-                tokens.append(Token(kind, value, line_num, start + 1))
-                continue
-
-            if ch in SINGLE:
-                kind = "OP" if ch in "+-*/%=<>!|" else "PUNCT"
-                tokens.append(Token(kind, ch, line_num, i + 1))
-                i += 1
-                continue
-
-            if ch == "~":
-                tokens.append(Token("KEYWORD", "~", line_num, i + 1))
-                i += 1
-                continue
-
-            raise ValueError(f"Unexpected character '{ch}' at line {line_num}:{i + 1}")
-
-        tokens.append(Token("NEWLINE", "", line_num, len(raw) + 1))
+        yield Token("NEWLINE", "", line_num, len(raw) + 1)
 
     while len(indent_stack) > 1:
         indent_stack.pop()
-        tokens.append(Token("DEDENT", "", len(lines) + 1, 1))
+        yield Token("DEDENT", "", line_num + 1, 1)
+
+    yield Token("EOF", "", line_num + 1, 1)
 
-    tokens.append(Token("EOF", "", len(lines) + 1, 1))
-    return tokens
+
+def tokenize(source: str) -> list[Token]:
+    return list(iter_tokens(source))
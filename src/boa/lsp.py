@@ -0,0 +1,138 @@
+"""`boa lsp`: a Language Server Protocol server that publishes Boa diagnostics.
+
+Speaks JSON-RPC over stdin/stdout with incremental text sync. Every open file
+is a `document.Document`, so a `didChange` re-checks only the declarations the
+edit touched before the document's diagnostics are published again.
+Positions are taken as code points, which matches UTF-16 for all but astral
+characters.
+"""
+
+from __future__ import annotations
+
+import json
+import sys
+from typing import Any, BinaryIO
+
+from . import __version__
+from .document import Document
+
+_SYNC_INCREMENTAL = 2
+_SEVERITY_ERROR = 1
+_METHOD_NOT_FOUND = -32601
+
+
+def read_message(stream: BinaryIO) -> dict[str, Any] | None:
+    """The next framed JSON-RPC message, or None at end of input."""
+    length = None
+    while True:
+        line = stream.readline()
+        if not line:
+            return None
+        line = line.strip()
+        if not line:
+            break
+        name, _, value = line.decode("ascii").partition(":")
+        if name.strip().lower() == "content-length":
+            length = int(value)
+    if length is None:
+        raise ValueError("LSP message without Content-Length header")
+    return json.loads(stream.read(length))
+
+
+def write_message(stream: BinaryIO, message: dict[str, Any]) -> None:
+    body = json.dumps(message, separators=(",", ":")).encode("utf-8")
+    stream.write(b"Content-Length: %d\r\n\r\n%s" % (len(body), body))
+    stream.flush()
+
+
+class Server:
+    def __init__(self, output: BinaryIO) -> None:
+        self.output = output
+        self.documents: dict[str, Document] = {}
+        self.shut_down = False
+
+    def handle(self, message: dict[str, Any]) -> bool:
+        """Process one message; returns False once the client asked the server to exit."""
+        method = message.get("method")
+        params = message.get("params") or {}
+        if method == "initialize":
+            self._respond(
+                message,
+                {
+                    "capabilities": {"textDocumentSync": {"openClose": True, "change": _SYNC_INCREMENTAL}},
+                    "serverInfo": {"name": "boa", "version": __version__},
+                },
+            )
+        elif method == "textDocument/didOpen":
+            item = params["textDocument"]
+            self.documents[item["uri"]] = Document(item["text"])
+            self._publish(item["uri"])
+        elif method == "textDocument/didChange":
+            uri = params["textDocument"]["uri"]
+            document = self.documents[uri]
+            for change in params["contentChanges"]:
+                if "range" in change:
+                    start, end = change["range"]["start"], change["range"]["end"]
+                    document.edit(start["line"], start["character"], end["line"], end["character"], change["text"])
+                else:
+                    document.set_text(change["text"])
+            self._publish(uri)
+        elif method == "textDocument/didClose":
+            uri = params["textDocument"]["uri"]
+            self.documents.pop(uri, None)
+            write_message(self.output, _notification(uri, []))
+        elif method == "shutdown":
+            self.shut_down = True
+            self._respond(message, None)
+        elif method == "exit":
+            return False
+        elif "id" in message and method is not None:
+            write_message(
+                self.output,
+                {
+                    "jsonrpc": "2.0",
+                    "id": message["id"],
+                    "error": {"code": _METHOD_NOT_FOUND, "message": f"Unsupported method {method}"},
+                },
+            )
+        # Other notifications (`initialized`, `$/...`) need no reply.
+        return True
+
+    def _respond(self, request: dict[str, Any], result: Any) -> None:
+        write_message(self.output, {"jsonrpc": "2.0", "id": request["id"], "result": result})
+
+    def _publish(self, uri: str) -> None:
+        document = self.documents[uri]
+        diagnostics = []
+        for diagnostic in document.diagnostics():
+            end = len(document.line(diagnostic.line))
+            diagnostics.append(
+                {
+                    "range": {
+                        "start": {"line": diagnostic.line, "character": diagnostic.column},
+                        "end": {"line": diagnostic.line, "character": max(end, diagnostic.column)},
+                    },
+                    "severity": _SEVERITY_ERROR,
+                    "source": "boa",
+                    "message": diagnostic.message,
+                }
+            )
+        write_message(self.output, _notification(uri, diagnostics))
+
+
+def _notification(uri: str, diagnostics: list[dict[str, Any]]) -> dict[str, Any]:
+    return {
+        "jsonrpc": "2.0",
+        "method": "textDocument/publishDiagnostics",
+        "params": {"uri": uri, "diagnostics": diagnostics},
+    }
+
+
+def serve(input_stream: BinaryIO | None = None, output_stream: BinaryIO | None = None) -> int:
+    """Serve until `exit`; the exit code is 0 only after a clean `shutdown`."""
+    input_stream = input_stream or sys.stdin.buffer
+    server = Server(output_stream or sys.stdout.buffer)
+    while True:
+        message = read_message(input_stream)
+        if message is None or not server.handle(message):
+            return 0 if server.shut_down else 1
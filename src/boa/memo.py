@@ -0,0 +1,59 @@
+"""Result caches of `memo fn` functions.
+
+`memo fn classify(code: i) -> s:` declares that the function's result depends
+only on its arguments. Each such function keeps the results of its most
+recent `MEMO_SIZE` distinct argument tuples; a call with one of them returns
+the cached result without running the body, and the least recently used
+entry is dropped once the cache is full. Semantic analysis rejects a memo
+body that prints with `out`, reads with `ask` or assigns attributes, since a
+cached call would skip those effects.
+
+Arguments are compared the way the constant pools compare literals (see
+`bytecode.const_key`): by value and by type, so `f(1)`, `f(1.0)` and `f(yes)`
+are separate entries, and by sign for floats, so `f(0.0)` and `f(-0.0)` are
+too. A call with an unhashable argument (a list or
+a map) runs the body and caches nothing.
+"""
+
+from __future__ import annotations
+
+from collections import OrderedDict
+from typing import Any
+
+from .bytecode import const_key
+
+# Entries kept per `memo fn`.
+MEMO_SIZE = 4096
+
+# Returned by `MemoCache.get` for a key with no entry.
+MISSING: Any = object()
+
+
+def memo_key(args: list[Any]) -> tuple[Any, ...] | None:
+    """The cache key of a call with `args`, or None when they cannot be one."""
+    key = tuple(map(const_key, args))
+    try:
+        hash(key)
+    except TypeError:
+        return None
+    return key
+
+
+class MemoCache:
+    __slots__ = ("entries", "size")
+
+    def __init__(self, size: int = MEMO_SIZE) -> None:
+        self.entries: OrderedDict[tuple[Any, ...], Any] = OrderedDict()
+        self.size = size
+
+    def get(self, key: tuple[Any, ...]) -> Any:
+        value = self.entries.get(key, MISSING)
+        if value is not MISSING:
+            self.entries.move_to_end(key)
+        return value
+
+    def store(self, key: tuple[Any, ...], value: Any) -> None:
+        entries = self.entries
+        entries[key] = value
+        if len(entries) > self.size:
+            entries.popitem(last=False)
@@ -0,0 +1,53 @@
+"""Frame pooling and the allocation counters behind `boa run --mem-stats`.
+
+Each function call needs a frame: an `Env` in the tree-walker, a `vm.Frame`
+in the VM. Instead of leaving a finished call's frame to the garbage collector
+and allocating a new one for the next call, both engines put it on a free list
+of up to `POOL_SIZE` frames and reuse it. A frame is only allocated when more
+calls are live at once than the pool holds, so a program allocates about as
+many frames as its deepest call stack, however many calls it makes. Frames
+that outlive their call (a tree-walker `Env` captured by a nested `fn` or
+`cls`, a coroutine's frame) are never pooled.
+
+`STATS` counts frame and instance allocations and the deepest call stack.
+The counters sit on allocation paths and on the first call at each new depth
+only, so they are always on; `--mem-stats` prints them with the run's peak
+traced memory.
+"""
+
+from __future__ import annotations
+
+# Most finished frames each engine keeps for reuse.
+POOL_SIZE = 256
+
+
+class MemStats:
+    __slots__ = ("frames", "instances", "peak_frames")
+
+    def __init__(self) -> None:
+        self.reset()
+
+    def reset(self) -> None:
+        # Frames allocated rather than taken from a pool.
+        self.frames = 0
+        self.instances = 0
+        # Deepest call stack, in frames.
+        self.peak_frames = 0
+
+    def reached(self, depth: int) -> None:
+        if depth > self.peak_frames:
+            self.peak_frames = depth
+
+    def report(self, engine: str, peak_bytes: int) -> str:
+        return "\n".join(
+            [
+                f"Memory ({engine} engine)",
+                f"  peak call depth     {self.peak_frames:>12,} frames",
+                f"  frames allocated    {self.frames:>12,}",
+                f"  instances allocated {self.instances:>12,}",
+                f"  peak traced memory  {peak_bytes / 1024:>12,.1f} KiB",
+            ]
+        )
+
+
+STATS = MemStats()
@@ -0,0 +1,125 @@
+"""Boa modules: what `use name` finds, compiles and runs.
+
+`use util` binds a lazy module. The first member access (`util.helper`, or
+`use util: helper` binding its names) looks `util.boa` up on the search
+path (the directory of the program being run, then each entry of
+`$BOA_PATH`) and runs it once per run in its own global scope; its
+members are its top-level variables, functions and classes. An import that
+is never used is never read from disk.
+
+Compiled modules are kept for the rest of the process, keyed by path and
+modification time, and the vm engine also keeps them in the on-disk compile
+cache (see `cache`), so a later run only re-reads an unchanged module's
+bytes to hash them.
+"""
+
+from __future__ import annotations
+
+import os
+from pathlib import Path
+from typing import Any
+
+from . import cache
+from .bytecode import compile_program
+from .errors import BoaError
+from .optimizer import DEFAULT_LEVEL, optimize
+from .parser import parse_source
+from .runtime import DEFAULT_MAX_STACK, BoaModule, Env, RuntimeErrorBoa, exec_module
+from .semantic import analyze
+from .vm import VM
+
+SUFFIX = ".boa"
+
+# Compiled modules of this process: (path, engine, -O level) ->
+# ((mtime_ns, size), optimized Program for the tree engine or CodeObject).
+_compiled: dict[tuple[Path, str, int], tuple[tuple[int, int], Any]] = {}
+
+
+def search_path(origin: str | Path | None = None) -> list[Path]:
+    """Directories searched by the `use` statements of the program at `origin`.
+
+    Without an origin (source given as text) the current directory comes first.
+    """
+    first = Path.cwd() if origin is None else Path(origin).resolve().parent
+    extra = [Path(entry) for entry in os.environ.get("BOA_PATH", "").split(os.pathsep) if entry]
+    return [first, *extra]
+
+
+class ModuleLoader:
+    """Resolves and loads the Boa modules of one run on one engine."""
+
+    def __init__(
+        self,
+        path: list[Path],
+        engine: str = "vm",
+        *,
+        opt_level: int = DEFAULT_LEVEL,
+        use_cache: bool = True,
+        max_stack: int = DEFAULT_MAX_STACK,
+    ) -> None:
+        self.path = path
+        self.engine = engine
+        self.opt_level = opt_level
+        self.use_cache = use_cache and cache.enabled()
+        self.max_stack = max_stack
+        self._modules: dict[str, BoaModule] = {}
+        # Globals of every module file run so far. An entry is added before
+        # the body runs, so an import cycle sees the partly run module.
+        self._globals: dict[Path, dict[str, Any]] = {}
+
+    def module(self, name: str) -> BoaModule:
+        module = self._modules.get(name)
+        if module is None:
+            module = self._modules[name] = BoaModule(name, load=lambda: self._load(name))
+        return module
+
+    def find(self, name: str) -> Path | None:
+        for directory in self.path:
+            candidate = directory / (name + SUFFIX)
+            if candidate.is_file():
+                return candidate.resolve()
+        return None
+
+    def _load(self, name: str) -> dict[str, Any]:
+        path = self.find(name)
+        if path is None:
+            searched = ", ".join(str(directory) for directory in self.path)
+            raise RuntimeErrorBoa(f"Unknown module '{name}' (searched: {searched})")
+        values = self._globals.get(path)
+        if values is not None:
+            return values
+        compiled = self._compile(name, path)
+        env = Env()
+        self._globals[path] = env.values
+        try:
+            if self.engine == "tree":
+                exec_module(compiled, env)
+            else:
+                VM(env, None, self.max_stack, self).exec_module(compiled)
+        except BaseException:
+            del self._globals[path]
+            raise
+        return env.values
+
+    def _compile(self, name: str, path: Path) -> Any:
+        stat = path.stat()
+        signature = (stat.st_mtime_ns, stat.st_size)
+        key = (path, self.engine, self.opt_level)
+        hit = _compiled.get(key)
+        if hit is not None and hit[0] == signature:
+            return hit[1]
+        data = path.read_bytes()
+        compiled = cache.lookup(data, self.opt_level) if self.use_cache and self.engine == "vm" else None
+        if compiled is None:
+            try:
+                program = parse_source(data.decode("utf-8"))
+                analyze(program)
+            except (BoaError, ValueError, UnicodeDecodeError) as exc:
+                raise RuntimeErrorBoa(f"Cannot load module '{name}' from {path}: {exc}") from exc
+            compiled = optimize(program, self.opt_level)
+            if self.engine == "vm":
+                compiled = compile_program(compiled)
+                if self.use_cache:
+                    cache.store(data, compiled, self.opt_level)
+        _compiled[key] = (signature, compiled)
+        return compiled
@@ -0,0 +1,736 @@
+"""Native backend behind `boa build --native`: typed functions as C++.
+
+`lower` translates every module-level `fn` whose parameters and result are
+annotated `i`, `f`, `b`, `[i]` or `[f]` and whose body stays within what
+those types express exactly (arithmetic, comparisons, locals, `if`/`while`,
+`for` over `range()` or a list parameter, `len()` of a list, `ret`, and calls
+to other such functions) into C++. `build_library` compiles that into a
+shared library next to the `.boac` artifact, and `attach` binds it when the
+artifact runs. Everything else (strings, dicts, classes, `out`, globals,
+coroutines) stays bytecode and calls native functions like any other.
+
+The call boundary is a plain C ABI: `boa_<name>(args..., result*)` returns 0
+with the result written, or non-zero when native code cannot produce exactly
+the value Boa would: int64 overflow, a zero divisor, a `range()` step of 0,
+a path without `ret`, or deep recursion. Native functions have no side
+effects, so the caller then reruns the call on the VM, which computes the big
+integer or raises the error as usual. Arguments whose run-time type differs
+from the annotation take the same way back.
+"""
+
+from __future__ import annotations
+
+import ctypes
+from dataclasses import dataclass, field
+import hashlib
+import os
+from pathlib import Path
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+from typing import Any
+
+from . import __version__
+from .arrays import TypedArray
+from .ast_nodes import (
+    AssignStmt,
+    BinaryExpr,
+    BoolExpr,
+    BreakStmt,
+    CallExpr,
+    ClassDef,
+    ContinueStmt,
+    Expr,
+    ExprStmt,
+    ForStmt,
+    FunctionDef,
+    IfStmt,
+    NameExpr,
+    NumberExpr,
+    PassStmt,
+    Program,
+    ReturnStmt,
+    UnaryExpr,
+    UseStmt,
+    WhileStmt,
+)
+from .bytecode import CodeObject
+from .errors import BoaError
+from .parser import parse_source
+from .semantic import analyze
+
+INT = "i"
+FLOAT = "f"
+BOOL = "b"
+INT_LIST = "[i]"
+FLOAT_LIST = "[f]"
+
+_SCALARS = {INT: "int64_t", FLOAT: "double", BOOL: "bool"}
+_LISTS = {INT_LIST: INT, FLOAT_LIST: FLOAT}
+_ARITH = {"+": "add", "-": "sub", "*": "mul"}
+_COMPARE = frozenset(("==", "!=", "<", ">", "<=", ">="))
+_IDENT = re.compile(r"[A-Za-z_][A-Za-z0-9_]*\Z")
+_INT64_MIN = -(1 << 63)
+_INT64_MAX = (1 << 63) - 1
+
+_LIBRARY_SUFFIX = {"win32": ".dll", "darwin": ".dylib"}.get(sys.platform, ".so")
+# ISO C++ keeps float expressions unfused, as Python evaluates them, and
+# loops without side effects must still run (or hang) as they would in Boa.
+_CXX_FLAGS = ["-std=c++17", "-O2", "-shared", "-fPIC", "-ffp-contract=off", "-fno-finite-loops"]
+
+_PRELUDE = r"""#include <cmath>
+#include <cstdint>
+
+// Deeper native recursion falls back to the VM, which enforces --max-stack.
+static const int kMaxDepth = 10000;
+
+static inline int64_t boa_add(int64_t a, int64_t b, bool& bad) {
+    int64_t r;
+    if (__builtin_add_overflow(a, b, &r)) bad = true;
+    return r;
+}
+static inline int64_t boa_sub(int64_t a, int64_t b, bool& bad) {
+    int64_t r;
+    if (__builtin_sub_overflow(a, b, &r)) bad = true;
+    return r;
+}
+static inline int64_t boa_mul(int64_t a, int64_t b, bool& bad) {
+    int64_t r;
+    if (__builtin_mul_overflow(a, b, &r)) bad = true;
+    return r;
+}
+static inline int64_t boa_neg(int64_t a, bool& bad) {
+    if (a == INT64_MIN) { bad = true; return 0; }
+    return -a;
+}
+// int / int is exact in doubles only below 2**53; Python rounds the true quotient.
+static inline double boa_idiv(int64_t a, int64_t b, bool& bad) {
+    const int64_t exact = INT64_C(1) << 53;
+    if (b == 0 || a > exact || a < -exact || b > exact || b < -exact) { bad = true; return 0; }
+    return (double)a / (double)b;
+}
+static inline double boa_fdiv(double a, double b, bool& bad) {
+    if (b == 0) { bad = true; return 0; }
+    return a / b;
+}
+// Python's `%` takes the sign of the divisor.
+static inline int64_t boa_imod(int64_t a, int64_t b, bool& bad) {
+    if (b == 0) { bad = true; return 0; }
+    if (b == -1) return 0;
+    int64_t r = a % b;
+    if (r != 0 && ((r < 0) != (b < 0))) r += b;
+    return r;
+}
+static inline double boa_fmod(double a, double b, bool& bad) {
+    if (b == 0) { bad = true; return 0; }
+    double r = std::fmod(a, b);
+    if (r != 0) {
+        if ((b < 0) != (r < 0)) r += b;
+    } else {
+        r = std::copysign(0.0, b);
+    }
+    return r;
+}
+static inline int64_t boa_next(int64_t k, int64_t step, int64_t stop) {
+    int64_t r;
+    return __builtin_add_overflow(k, step, &r) ? stop : r;
+}
+"""
+
+
+class NativeError(BoaError):
+    """Raised when a native library cannot be built or does not match its artifact."""
+
+
+class _Unsupported(Exception):
+    """A construct the native backend does not lower; the function stays bytecode."""
+
+
+@dataclass(frozen=True)
+class NativeSignature:
+    name: str
+    params: tuple[str, ...]
+    result: str
+
+
+@dataclass
+class NativeUnit:
+    """The outcome of `lower`: C++ for the native functions, and why the others were left out."""
+
+    functions: list[NativeSignature] = field(default_factory=list)
+    definitions: list[str] = field(default_factory=list)
+    skipped: dict[str, str] = field(default_factory=dict)
+
+    def source(self, digest: str) -> str:
+        manifest = "\\n".join(
+            [digest] + [f"{sig.name}\\t{','.join(sig.params)}\\t{sig.result}" for sig in self.functions]
+        )
+        parts = [_PRELUDE]
+        parts += [_declaration(sig) for sig in self.functions]
+        parts += self.definitions
+        parts.append(f'extern "C" const char* boa_manifest(void) {{ return "{manifest}"; }}\n')
+        return "\n".join(parts)
+
+
+def _c_params(sig: NativeSignature, names: list[str]) -> list[str]:
+    out = []
+    for name, kind in zip(names, sig.params):
+        if kind in _LISTS:
+            out += [f"const {_SCALARS[_LISTS[kind]]}* v_{name}", f"int64_t n_{name}"]
+        else:
+            out.append(f"{_SCALARS[kind]} v_{name}")
+    return out
+
+
+def _arg_names(sig: NativeSignature) -> list[str]:
+    return [f"a{i}" for i in range(len(sig.params))]
+
+
+def _forward(sig: NativeSignature, names: list[str]) -> list[str]:
+    out = []
+    for name, kind in zip(names, sig.params):
+        out += [f"v_{name}", f"n_{name}"] if kind in _LISTS else [f"v_{name}"]
+    return out
+
+
+def _declaration(sig: NativeSignature) -> str:
+    names = _arg_names(sig)
+    params = _c_params(sig, names)
+    result = _SCALARS[sig.result]
+    forward = ", ".join(_forward(sig, names))
+    head = ", ".join(params + [f"{result}* out", "int depth"])
+    call = ", ".join(params + ["int depth", "bool& bad"])
+    extern = ", ".join(params + [f"{result}* out"])
+    sep = ", " if forward else ""
+    return (
+        f"static int f_{sig.name}({head});\n"
+        f"static inline {result} e_{sig.name}({call}) {{\n"
+        f"    {result} r{{}};\n"
+        f"    if (!bad && f_{sig.name}({forward}{sep}&r, depth + 1)) bad = true;\n"
+        f"    return r;\n"
+        f"}}\n"
+        f'extern "C" int boa_{sig.name}({extern}) {{ return f_{sig.name}({forward}{sep}out, 0); }}\n'
+    )
+
+
+def _signature(stmt: FunctionDef) -> NativeSignature:
+    if stmt.is_async:
+        raise _Unsupported("afn")
+    if stmt.memo:
+        raise _Unsupported("memo fn")
+    if not _IDENT.match(stmt.name):
+        raise _Unsupported("name is not a C identifier")
+    params = []
+    for param in stmt.params:
+        kind = param.annotation
+        if kind not in _SCALARS and kind not in _LISTS:
+            raise _Unsupported(f"parameter '{param.name}' is not annotated i, f, b, [i] or [f]")
+        if not _IDENT.match(param.name):
+            raise _Unsupported(f"parameter '{param.name}' is not a C identifier")
+        params.append(kind)
+    if stmt.return_annotation not in _SCALARS:
+        raise _Unsupported("result is not annotated i, f or b")
+    return NativeSignature(stmt.name, tuple(params), stmt.return_annotation)
+
+
+def _assigned_names(stmts: list) -> set[str]:
+    names: set[str] = set()
+    for stmt in stmts:
+        if isinstance(stmt, AssignStmt):
+            names.add(stmt.name)
+        elif isinstance(stmt, ForStmt):
+            names.add(stmt.var_name)
+            names |= _assigned_names(stmt.body)
+        elif isinstance(stmt, WhileStmt):
+            names |= _assigned_names(stmt.body)
+        elif isinstance(stmt, IfStmt):
+            names |= _assigned_names(stmt.body)
+            for _, block in stmt.elif_blocks:
+                names |= _assigned_names(block)
+            names |= _assigned_names(stmt.else_body or [])
+    return names
+
+
+class _Lowering:
+    """Lowers one function; raises `_Unsupported` at the first construct it cannot express."""
+
+    def __init__(
+        self,
+        stmt: FunctionDef,
+        sig: NativeSignature,
+        callees: dict[str, NativeSignature],
+        module_names: set[str],
+    ) -> None:
+        self.stmt = stmt
+        self.sig = sig
+        self.callees = callees
+        self.module_names = module_names
+        # Boa locals are function-wide: parameters plus every assigned name.
+        self.locals = {p.name for p in stmt.params} | _assigned_names(stmt.body)
+        self.types = {p.name: kind for p, kind in zip(stmt.params, sig.params)}
+        self.lines: list[str] = []
+        self.temps = 0
+
+    def function(self) -> str:
+        names = [p.name for p in self.stmt.params]
+        _, stops = self._block(self.stmt.body, set(names), 1)
+        declared = [
+            f"    {_SCALARS[kind]} v_{name} = 0;\n"
+            for name, kind in self.types.items()
+            if name not in names
+        ]
+        head = ", ".join(_c_params(self.sig, names) + [f"{_SCALARS[self.sig.result]}* out", "int depth"])
+        return (
+            f"static int f_{self.sig.name}({head}) {{\n"
+            "    if (depth > kMaxDepth) return 1;\n"
+            "    bool bad = false;\n"
+            + "".join(declared)
+            + "".join(self.lines)
+            # Falling off the end returns nil, which only the VM can produce.
+            + ("" if stops else "    return 1;\n")
+            + "}\n"
+        )
+
+    def _emit(self, depth: int, text: str) -> None:
+        self.lines.append("    " * depth + text + "\n")
+
+    def _temp(self) -> str:
+        self.temps += 1
+        return f"t{self.temps}"
+
+    # Statements; `assigned` holds the locals bound on every path so far.
+
+    def _block(self, stmts: list, assigned: set[str], depth: int) -> tuple[set[str], bool]:
+        assigned = set(assigned)
+        for stmt in stmts:
+            if self._stmt(stmt, assigned, depth):
+                return assigned, True
+        return assigned, False
+
+    def _stmt(self, stmt: Any, assigned: set[str], depth: int) -> bool:
+        """Lower `stmt`, updating `assigned`; True when control never continues past it."""
+        if isinstance(stmt, PassStmt):
+            return False
+        if isinstance(stmt, AssignStmt):
+            code, kind = self._scalar(stmt.value, assigned)
+            if stmt.annotation is not None and stmt.annotation != kind:
+                raise _Unsupported(f"'{stmt.name}' is annotated {stmt.annotation} but assigned {kind}")
+            if self.types.setdefault(stmt.name, kind) != kind:
+                raise _Unsupported(f"'{stmt.name}' is assigned both {self.types[stmt.name]} and {kind}")
+            self._emit(depth, f"v_{stmt.name} = {code};")
+            self._emit(depth, "if (bad) return 1;")
+            assigned.add(stmt.name)
+            return False
+        if isinstance(stmt, ReturnStmt):
+            if stmt.value is None:
+                raise _Unsupported("'ret' without a value")
+            code, kind = self._scalar(stmt.value, assigned)
+            if kind != self.sig.result:
+                raise _Unsupported(f"returns {kind} from a function annotated {self.sig.result}")
+            temp = self._temp()
+            self._emit(depth, f"{_SCALARS[kind]} {temp} = {code};")
+            self._emit(depth, "if (bad) return 1;")
+            self._emit(depth, f"*out = {temp};")
+            self._emit(depth, "return 0;")
+            return True
+        if isinstance(stmt, ExprStmt):
+            code, _ = self._scalar(stmt.expr, assigned)
+            self._emit(depth, f"(void)({code});")
+            self._emit(depth, "if (bad) return 1;")
+            return False
+        if isinstance(stmt, IfStmt):
+            return self._if([(stmt.condition, stmt.body), *stmt.elif_blocks], stmt.else_body, assigned, depth)
+        if isinstance(stmt, WhileStmt):
+            self._emit(depth, "while (true) {")
+            code, _ = self._scalar(stmt.condition, assigned)
+            temp = self._temp()
+            self._emit(depth + 1, f"bool {temp} = {code};")
+            self._emit(depth + 1, "if (bad) return 1;")
+            self._emit(depth + 1, f"if (!{temp}) break;")
+            self._block(stmt.body, assigned, depth + 1)
+            self._emit(depth, "}")
+            return False
+        if isinstance(stmt, ForStmt):
+            self._for(stmt, assigned, depth)
+            return False
+        if isinstance(stmt, BreakStmt):
+            self._emit(depth, "break;")
+            return True
+        if isinstance(stmt, ContinueStmt):
+            self._emit(depth, "continue;")
+            return True
+        raise _Unsupported(f"{type(stmt).__name__} statement")
+
+    def _if(self, branches: list, else_body: list | None, assigned: set[str], depth: int) -> bool:
+        cond, body = branches[0]
+        code, _ = self._scalar(cond, assigned)
+        temp = self._temp()
+        self._emit(depth, "{")
+        self._emit(depth + 1, f"bool {temp} = {code};")
+        self._emit(depth + 1, "if (bad) return 1;")
+        self._emit(depth + 1, f"if ({temp}) {{")
+        outcomes = [self._block(body, assigned, depth + 2)]
+        if branches[1:]:
+            self._emit(depth + 1, "} else {")
+            rest = set(assigned)
+            outcomes.append((rest, self._if(branches[1:], else_body, rest, depth + 2)))
+        elif else_body is not None:
+            self._emit(depth + 1, "} else {")
+            outcomes.append(self._block(else_body, assigned, depth + 2))
+        else:
+            outcomes.append((set(assigned), False))
+        self._emit(depth + 1, "}")
+        self._emit(depth, "}")
+        # Names bound on every branch that carries on past the `if`.
+        live = [names for names, stops in outcomes if not stops]
+        if live:
+            assigned |= set.intersection(*live)
+        return not live
+
+    def _for(self, stmt: ForStmt, assigned: set[str], depth: int) -> None:
+        iterable, var = stmt.iterable, stmt.var_name
+        counter = self._temp()
+        if isinstance(iterable, NameExpr) and self.types.get(iterable.name) in _LISTS and iterable.name in assigned:
+            kind = _LISTS[self.types[iterable.name]]
+            bounds = None
+            head = f"for (int64_t {counter} = 0; {counter} < n_{iterable.name}; ++{counter}) {{"
+            value = f"v_{iterable.name}[{counter}]"
+        elif self._is_builtin_call(iterable, "range") and 1 <= len(iterable.args) <= 3:
+            kind = INT
+            bounds = [self._typed(arg, assigned, INT) for arg in iterable.args]
+            if len(bounds) == 1:
+                bounds.insert(0, "INT64_C(0)")
+            if len(bounds) == 2:
+                bounds.append("INT64_C(1)")
+            start, stop, step = self._temp(), self._temp(), self._temp()
+            head = (
+                f"for (int64_t {counter} = {start}; {step} > 0 ? {counter} < {stop} : {counter} > {stop}; "
+                f"{counter} = boa_next({counter}, {step}, {stop})) {{"
+            )
+            value = counter
+        else:
+            raise _Unsupported("'for' over something other than range() or a list parameter")
+        if self.types.setdefault(var, kind) != kind:
+            raise _Unsupported(f"loop variable '{var}' is {self.types[var]}, not {kind}")
+        if bounds is not None:
+            # Evaluated once, like Python's range(); a zero step raises there.
+            self._emit(depth, "{")
+            depth += 1
+            self._emit(depth, f"int64_t {start} = {bounds[0]}, {stop} = {bounds[1]}, {step} = {bounds[2]};")
+            self._emit(depth, "if (bad) return 1;")
+            self._emit(depth, f"if ({step} == 0) return 1;")
+        self._emit(depth, head)
+        self._emit(depth + 1, f"v_{var} = {value};")
+        self._block(stmt.body, assigned | {var}, depth + 1)
+        self._emit(depth, "}")
+        if bounds is not None:
+            self._emit(depth - 1, "}")
+
+    # Expressions lower to `(C++ code, Boa type)`.
+
+    def _is_builtin_call(self, expr: Expr, name: str) -> bool:
+        return (
+            isinstance(expr, CallExpr)
+            and isinstance(expr.func, NameExpr)
+            and expr.func.name == name
+            and name not in self.locals
+            and name not in self.module_names
+        )
+
+    def _typed(self, expr: Expr, assigned: set[str], kind: str) -> str:
+        code, got = self._scalar(expr, assigned)
+        if got != kind:
+            raise _Unsupported(f"expected {kind}, got {got}")
+        return code
+
+    def _scalar(self, expr: Expr, assigned: set[str]) -> tuple[str, str]:
+        code, kind = self._expr(expr, assigned)
+        if kind not in _SCALARS:
+            raise _Unsupported(f"a {kind} value outside 'for', len() or a call")
+        return code, kind
+
+    def _expr(self, expr: Expr, assigned: set[str]) -> tuple[str, str]:
+        if isinstance(expr, NumberExpr):
+            value = expr.value
+            if isinstance(value, int):
+                if value > _INT64_MAX:
+                    raise _Unsupported("integer literal beyond int64")
+                return f"INT64_C({value})", INT
+            if value != value or value in (float("inf"), float("-inf")):
+                raise _Unsupported("non-finite float literal")
+            return value.hex(), FLOAT
+        if isinstance(expr, BoolExpr):
+            return ("true" if expr.value else "false"), BOOL
+        if isinstance(expr, NameExpr):
+            if expr.name not in self.locals:
+                raise _Unsupported(f"reads the global '{expr.name}'")
+            if expr.name not in assigned or expr.name not in self.types:
+                raise _Unsupported(f"'{expr.name}' may be read before it is assigned")
+            return f"v_{expr.name}", self.types[expr.name]
+        if isinstance(expr, UnaryExpr):
+            code, kind = self._scalar(expr.expr, assigned)
+            if expr.op == "!":
+                return f"(!{code})", BOOL
+            if expr.op == "-" and kind == INT:
+                return f"boa_neg({code}, bad)", INT
+            if expr.op == "-" and kind == FLOAT:
+                return f"(-{code})", FLOAT
+            raise _Unsupported(f"unary '{expr.op}' on {kind}")
+        if isinstance(expr, BinaryExpr):
+            return self._binary(expr, assigned)
+        if isinstance(expr, CallExpr):
+            return self._call(expr, assigned)
+        raise _Unsupported(f"{type(expr).__name__} expression")
+
+    def _binary(self, expr: BinaryExpr, assigned: set[str]) -> tuple[str, str]:
+        left, lkind = self._scalar(expr.left, assigned)
+        right, rkind = self._scalar(expr.right, assigned)
+        op = expr.op
+        if op in ("&&", "||"):
+            return f"({left} {op} {right})", BOOL
+        if op in _COMPARE:
+            if lkind != rkind:
+                raise _Unsupported(f"compares {lkind} with {rkind}")
+            return f"({left} {op} {right})", BOOL
+        if BOOL in (lkind, rkind) or op not in ("+", "-", "*", "/", "%"):
+            raise _Unsupported(f"'{op}' on {lkind} and {rkind}")
+        if lkind == rkind == INT:
+            if op == "/":
+                return f"boa_idiv({left}, {right}, bad)", FLOAT
+            if op == "%":
+                return f"boa_imod({left}, {right}, bad)", INT
+            return f"boa_{_ARITH[op]}({left}, {right}, bad)", INT
+        # Python converts the int operand of a mixed operation to float first.
+        if lkind == INT:
+            left = f"(double){left}"
+        if rkind == INT:
+            right = f"(double){right}"
+        if op == "/":
+            return f"boa_fdiv({left}, {right}, bad)", FLOAT
+        if op == "%":
+            return f"boa_fmod({left}, {right}, bad)", FLOAT
+        return f"({left} {op} {right})", FLOAT
+
+    def _call(self, expr: CallExpr, assigned: set[str]) -> tuple[str, str]:
+        if self._is_builtin_call(expr, "len") and len(expr.args) == 1:
+            arg = expr.args[0]
+            if isinstance(arg, NameExpr) and self.types.get(arg.name) in _LISTS and arg.name in assigned:
+                return f"n_{arg.name}", INT
+            raise _Unsupported("len() of something other than a list parameter")
+        func = expr.func
+        if not isinstance(func, NameExpr) or func.name in self.locals or func.name not in self.callees:
+            raise _Unsupported("calls a function that is not native")
+        sig = self.callees[func.name]
+        if len(expr.args) != len(sig.params):
+            raise _Unsupported(f"calls {func.name} with {len(expr.args)} arguments")
+        args = []
+        for arg, kind in zip(expr.args, sig.params):
+            if kind in _LISTS:
+                if not (isinstance(arg, NameExpr) and self.types.get(arg.name) == kind and arg.name in assigned):
+                    raise _Unsupported(f"passes something other than a {kind} parameter to {func.name}")
+                args += [f"v_{arg.name}", f"n_{arg.name}"]
+            else:
+                args.append(self._typed(arg, assigned, kind))
+        return f"e_{func.name}({', '.join(args + ['depth', 'bad'])})", sig.result
+
+
+def _rebound_names(program: Program) -> set[str]:
+    """Module-level names bound other than by a `fn`, which native code must not assume."""
+    names: set[str] = set()
+    for stmt in program.statements:
+        if isinstance(stmt, (AssignStmt, ClassDef)):
+            names.add(stmt.name)
+        elif isinstance(stmt, ForStmt):
+            names.add(stmt.var_name)
+        elif isinstance(stmt, UseStmt):
+            names.update(stmt.names or [stmt.module])
+    return names
+
+
+def lower(program: Program) -> NativeUnit:
+    """Select the module-level functions that can run natively and translate them to C++."""
+    unit = NativeUnit()
+    rebound = _rebound_names(program)
+    module_names = rebound | {stmt.name for stmt in program.statements if isinstance(stmt, FunctionDef)}
+    candidates: dict[str, tuple[FunctionDef, NativeSignature]] = {}
+    for stmt in program.statements:
+        if isinstance(stmt, FunctionDef):
+            try:
+                if stmt.name in rebound:
+                    raise _Unsupported(f"'{stmt.name}' is rebound at module level")
+                candidates[stmt.name] = (stmt, _signature(stmt))
+            except _Unsupported as exc:
+                unit.skipped[stmt.name] = str(exc)
+    # A function calling one that turned out not to be native is not native
+    # either, so drop failures until the remaining set lowers cleanly.
+    while True:
+        callees = {name: sig for name, (_, sig) in candidates.items()}
+        definitions: dict[str, str] = {}
+        for name, (stmt, sig) in list(candidates.items()):
+            try:
+                definitions[name] = _Lowering(stmt, sig, callees, module_names).function()
+            except _Unsupported as exc:
+                unit.skipped[name] = str(exc)
+                del candidates[name]
+        if len(definitions) == len(callees):
+            break
+    unit.functions = [sig for _, sig in candidates.values()]
+    unit.definitions = [definitions[sig.name] for sig in unit.functions]
+    return unit
+
+
+def library_path(artifact: str | Path) -> Path:
+    """Where `build --native` puts the library of the `.boac` file `artifact`."""
+    return Path(artifact).with_suffix(_LIBRARY_SUFFIX)
+
+
+def _digest(artifact: bytes) -> str:
+    return hashlib.sha256(f"boa {__version__} native\0".encode("ascii") + artifact).hexdigest()
+
+
+def _compiler() -> str:
+    cxx = os.environ.get("CXX") or shutil.which("c++") or shutil.which("g++") or shutil.which("clang++")
+    if not cxx:
+        raise NativeError("--native needs a C++ compiler; install one or set $CXX")
+    return cxx
+
+
+def build_library(source: str, artifact: bytes, output: str | Path) -> bool:
+    """Compile the native functions of `source` into `output`; returns False when it was up to date.
+
+    `artifact` is the `.boac` the library belongs to. A program without any
+    native function gets no library, and a stale one is removed.
+    """
+    output = Path(output)
+    digest = _digest(artifact)
+    try:
+        if digest.encode("ascii") in output.read_bytes():
+            return False
+    except OSError:
+        pass
+    program = parse_source(source)
+    analyze(program)
+    unit = lower(program)
+    if not unit.functions:
+        if output.exists():
+            output.unlink()
+            return True
+        return False
+    cxx = _compiler()
+    with tempfile.TemporaryDirectory(dir=output.parent, prefix=".boa-native-") as tmp:
+        cpp = Path(tmp) / "native.cpp"
+        cpp.write_text(unit.source(digest), encoding="utf-8")
+        built = Path(tmp) / output.name
+        result = subprocess.run([cxx, *_CXX_FLAGS, "-o", str(built), str(cpp)], capture_output=True, text=True)
+        if result.returncode != 0:
+            raise NativeError(f"C++ compilation of {output} failed:\n{result.stderr.strip()}")
+        # Replaced, never rewritten in place: a process may have the old one mapped.
+        os.replace(built, output)
+    return True
+
+
+_CTYPES = {INT: ctypes.c_int64, FLOAT: ctypes.c_double, BOOL: ctypes.c_bool}
+_TYPECODES = {INT: "q", FLOAT: "d"}
+
+
+def _fits(kind: str, value: Any) -> bool:
+    if kind == INT:
+        return type(value) is int and _INT64_MIN <= value <= _INT64_MAX
+    if kind == FLOAT:
+        return type(value) is float
+    return type(value) is bool
+
+
+class NativeEntry:
+    """One exported function of a loaded library."""
+
+    __slots__ = ("name", "params", "result", "func")
+
+    def __init__(self, name: str, params: list[str], result: str, func: Any) -> None:
+        self.name = name
+        self.params = params
+        self.result = result
+        self.func = func
+
+    def bind(self, fallback: Any, vm: Any) -> NativeFunction:
+        return NativeFunction(self, fallback, vm)
+
+    def convert(self, args: tuple[Any, ...]) -> list[Any] | None:
+        """The C arguments for `args`, or None when one does not have its annotated type."""
+        if len(args) != len(self.params):
+            return None
+        out: list[Any] = []
+        for kind, value in zip(self.params, args):
+            element = _LISTS.get(kind)
+            if element is None:
+                if not _fits(kind, value):
+                    return None
+                out.append(value)
+                continue
+            if type(value) is TypedArray and value.typecode == _TYPECODES[element]:
+                # A packed array already is the C buffer.
+                out += [(_CTYPES[element] * len(value)).from_buffer(value.data), len(value)]
+                continue
+            if type(value) is not list or not all(_fits(element, item) for item in value):
+                return None
+            out += [(_CTYPES[element] * len(value))(*value), len(value)]
+        return out
+
+
+class NativeFunction:
+    """A Boa function whose calls run native code, and the VM function on fallback."""
+
+    __slots__ = ("entry", "fallback", "vm")
+
+    def __init__(self, entry: NativeEntry, fallback: Any, vm: Any) -> None:
+        self.entry = entry
+        self.fallback = fallback
+        self.vm = vm
+
+    @property
+    def name(self) -> str:
+        return self.entry.name
+
+    def __call__(self, *args: Any) -> Any:
+        entry = self.entry
+        converted = entry.convert(args)
+        if converted is not None:
+            result = _CTYPES[entry.result]()
+            if not entry.func(*converted, ctypes.byref(result)):
+                return result.value
+        return self.vm.call(self.fallback, list(args))
+
+    def __repr__(self) -> str:
+        return f"<native fn {self.entry.name}>"
+
+
+def attach(code: CodeObject, artifact: bytes, library: str | Path) -> int:
+    """Bind `library`'s functions to the module-level functions of `code`; returns how many."""
+    library = Path(library)
+    try:
+        lib = ctypes.CDLL(str(library.resolve()))
+        manifest_fn = lib.boa_manifest
+    except (OSError, AttributeError) as exc:
+        raise NativeError(f"Cannot load native library {library}: {exc}") from exc
+    manifest_fn.restype = ctypes.c_char_p
+    lines = manifest_fn().decode("utf-8").split("\n")
+    if lines[0] != _digest(artifact):
+        raise NativeError(f"{library} was built for a different artifact; rebuild it with `boa build --native`")
+    functions = {const.name: const for const in code.constants if isinstance(const, CodeObject)}
+    for line in lines[1:]:
+        name, params_text, result = line.split("\t")
+        params = params_text.split(",") if params_text else []
+        func = getattr(lib, f"boa_{name}")
+        func.restype = ctypes.c_int
+        argtypes: list[Any] = []
+        for kind in params:
+            element = _LISTS.get(kind)
+            if element is None:
+                argtypes.append(_CTYPES[kind])
+            else:
+                argtypes += [ctypes.POINTER(_CTYPES[element]), ctypes.c_int64]
+        func.argtypes = [*argtypes, ctypes.POINTER(_CTYPES[result])]
+        functions[name].native = NativeEntry(name, params, result, func)
+    return len(lines) - 1
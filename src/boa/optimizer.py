@@ -0,0 +1,280 @@
+"""AST optimization pass run between semantic analysis and execution.
+
+Levels follow the usual compiler flags:
+
+* `-O0` leaves the program untouched.
+* `-O1` (the default) folds operators whose operands are literals, simplifies
+  `&&`/`||` with a literal operand and drops `if`/`ef`/`else` branches whose
+  condition is a literal, splicing a statically taken branch into the
+  enclosing block (blocks share their function's scope, so this is safe).
+  A `while` loop whose condition is a literal false is dropped.
+* `-O2` additionally removes statements that can never run or have no
+  effect: code after a `ret`, `break` or `continue` in the same block, bare
+  literal expression statements, `..` and loops over an empty list literal.
+
+Folding uses the same operator table as the VM, so a folded expression has
+exactly the value either engine would have computed. An operation that would
+fail at run time (`1 / 0`, `"a" + 1`) is left in place to fail there, as are
+results too large to be worth embedding as constants.
+"""
+
+from __future__ import annotations
+
+from dataclasses import replace
+from typing import Any
+
+from .ast_nodes import (
+    AssignStmt,
+    AttrAssignStmt,
+    AttrExpr,
+    AwaitExpr,
+    BinaryExpr,
+    BoolExpr,
+    BreakStmt,
+    CallExpr,
+    ClassDef,
+    ContinueStmt,
+    DictExpr,
+    Expr,
+    ExprStmt,
+    ForStmt,
+    FStringExpr,
+    FunctionDef,
+    IfStmt,
+    ListExpr,
+    NilExpr,
+    NumberExpr,
+    OutStmt,
+    PassStmt,
+    Program,
+    ReturnStmt,
+    Stmt,
+    StringExpr,
+    SuperCallExpr,
+    UnaryExpr,
+    WhileStmt,
+)
+from .bytecode import BINARY_OPS
+from .defaults import DEFAULT_LEVEL, LEVELS
+
+# Statements after which the rest of their block never runs.
+_JUMPS = (ReturnStmt, BreakStmt, ContinueStmt)
+
+# Identity results depend on object caching, so `==:`/`!==:` are never folded.
+_FOLDABLE = {symbol: func for symbol, func in BINARY_OPS if symbol not in ("==:", "!==:")}
+_MAX_STR = 4096
+_MAX_INT_BITS = 4096
+
+_NOTHING = object()
+
+
+def optimize(program: Program, level: int = DEFAULT_LEVEL) -> Program:
+    if level not in LEVELS:
+        raise ValueError(f"Unknown optimization level {level} (expected one of: 0, 1, 2)")
+    if level == 0:
+        return program
+    return Program(_Optimizer(level).block(program.statements))
+
+
+def _literal(expr: Expr) -> Any:
+    """The value of a literal expression, or `_NOTHING`."""
+    if isinstance(expr, (NumberExpr, StringExpr, BoolExpr)):
+        return expr.value
+    if isinstance(expr, NilExpr):
+        return None
+    return _NOTHING
+
+
+def _to_expr(value: Any) -> Expr | None:
+    if value is None:
+        return NilExpr()
+    if isinstance(value, bool):
+        return BoolExpr(value)
+    if isinstance(value, int):
+        return NumberExpr(value) if value.bit_length() <= _MAX_INT_BITS else None
+    if isinstance(value, float):
+        return NumberExpr(value)
+    if isinstance(value, str):
+        return StringExpr(value) if len(value) <= _MAX_STR else None
+    return None
+
+
+def _too_big(op: str, left: Any, right: Any) -> bool:
+    """Whether folding `left op right` would build a value past `_to_expr`'s limits.
+
+    Checked before evaluating, so dead code such as `"ab" * 1000000000` costs
+    nothing at compile time.
+    """
+    if op == "*":
+        if isinstance(left, int) and isinstance(right, str):
+            left, right = right, left
+        if isinstance(left, str) and isinstance(right, int):
+            return len(left) * right > _MAX_STR
+        if isinstance(left, int) and isinstance(right, int):
+            # The product has at least one bit fewer than the operands.
+            return left.bit_length() + right.bit_length() > _MAX_INT_BITS + 1
+    elif op == "+":
+        return isinstance(left, str) and isinstance(right, str) and len(left) + len(right) > _MAX_STR
+    elif op == "%":
+        # `%` on a string formats it, and a field width can ask for any size.
+        return isinstance(left, str)
+    return False
+
+
+def _as_bool(expr: Expr) -> Expr:
+    # `!!x` evaluates `x` once and yields its truthiness on both engines.
+    return UnaryExpr("!", UnaryExpr("!", expr, line=expr.line, column=expr.column), line=expr.line, column=expr.column)
+
+
+class _Optimizer:
+    def __init__(self, level: int) -> None:
+        self.level = level
+
+    # Statements -----------------------------------------------------------
+
+    def block(self, stmts: list[Stmt]) -> list[Stmt]:
+        out: list[Stmt] = []
+        for stmt in stmts:
+            out.extend(self.stmt(stmt))
+            if self.level >= 2 and out and isinstance(out[-1], _JUMPS):
+                break
+        return out
+
+    def stmt(self, stmt: Stmt) -> list[Stmt]:
+        if isinstance(stmt, IfStmt):
+            return self._if(stmt)
+        if isinstance(stmt, FunctionDef):
+            return [replace(stmt, body=self.block(stmt.body))]
+        if isinstance(stmt, ClassDef):
+            return [replace(stmt, body=self.block(stmt.body))]
+        if isinstance(stmt, ForStmt):
+            iterable = self.expr(stmt.iterable)
+            if self.level >= 2 and isinstance(iterable, ListExpr) and not iterable.elements:
+                return []
+            return [replace(stmt, iterable=iterable, body=self.block(stmt.body))]
+        if isinstance(stmt, WhileStmt):
+            condition = self.expr(stmt.condition)
+            value = _literal(condition)
+            if value is not _NOTHING and not value:
+                return []
+            return [replace(stmt, condition=condition, body=self.block(stmt.body))]
+        if isinstance(stmt, ReturnStmt):
+            return [stmt if stmt.value is None else replace(stmt, value=self.expr(stmt.value))]
+        if isinstance(stmt, AssignStmt):
+            return [replace(stmt, value=self.expr(stmt.value))]
+        if isinstance(stmt, AttrAssignStmt):
+            return [replace(stmt, target=self.expr(stmt.target), value=self.expr(stmt.value))]
+        if isinstance(stmt, OutStmt):
+            return [replace(stmt, expr=self.expr(stmt.expr))]
+        if isinstance(stmt, ExprStmt):
+            expr = self.expr(stmt.expr)
+            if self.level >= 2 and _literal(expr) is not _NOTHING:
+                return []
+            return [replace(stmt, expr=expr)]
+        if isinstance(stmt, PassStmt) and self.level >= 2:
+            return []
+        return [stmt]
+
+    def _if(self, stmt: IfStmt) -> list[Stmt]:
+        live: list[tuple[Expr, list[Stmt]]] = []
+        else_body = stmt.else_body
+        for cond, body in [(stmt.condition, stmt.body), *stmt.elif_blocks]:
+            cond = self.expr(cond)
+            value = _literal(cond)
+            if value is _NOTHING:
+                live.append((cond, self.block(body)))
+                continue
+            if value:
+                # Statically taken: later branches, `else` included, are dead.
+                else_body = body
+                break
+            # Statically skipped: drop the branch and keep testing the rest.
+        else_block = None if else_body is None else self.block(else_body)
+        if not live:
+            return else_block or []
+        first_cond, first_body = live[0]
+        return [
+            replace(
+                stmt,
+                condition=first_cond,
+                body=first_body,
+                elif_blocks=live[1:],
+                else_body=else_block,
+            )
+        ]
+
+    # Expressions ----------------------------------------------------------
+
+    def expr(self, expr: Expr) -> Expr:
+        if isinstance(expr, BinaryExpr):
+            return self._binary(expr)
+        if isinstance(expr, UnaryExpr):
+            inner = self.expr(expr.expr)
+            value = _literal(inner)
+            if value is not _NOTHING:
+                if expr.op == "!":
+                    return BoolExpr(not value)
+                if expr.op == "-" and isinstance(value, (int, float)) and not isinstance(value, bool):
+                    folded = _to_expr(-value)
+                    if folded is not None:
+                        return folded
+            return replace(expr, expr=inner)
+        if isinstance(expr, FStringExpr):
+            return self._fstring(expr)
+        if isinstance(expr, ListExpr):
+            return ListExpr([self.expr(e) for e in expr.elements], line=expr.line, column=expr.column)
+        if isinstance(expr, DictExpr):
+            return DictExpr([(self.expr(k), self.expr(v)) for k, v in expr.entries], line=expr.line, column=expr.column)
+        if isinstance(expr, CallExpr):
+            return CallExpr(self.expr(expr.func), [self.expr(a) for a in expr.args], line=expr.line, column=expr.column)
+        if isinstance(expr, AttrExpr):
+            return AttrExpr(self.expr(expr.target), expr.name, line=expr.line, column=expr.column)
+        if isinstance(expr, SuperCallExpr):
+            return replace(expr, args=[self.expr(a) for a in expr.args])
+        if isinstance(expr, AwaitExpr):
+            return AwaitExpr(self.expr(expr.expr), line=expr.line, column=expr.column)
+        return expr
+
+    def _binary(self, expr: BinaryExpr) -> Expr:
+        left = self.expr(expr.left)
+        right = self.expr(expr.right)
+        lvalue = _literal(left)
+        if expr.op in ("&&", "||"):
+            if lvalue is _NOTHING:
+                return replace(expr, left=left, right=right)
+            # A literal left operand decides whether `right` runs at all.
+            if bool(lvalue) == (expr.op == "||"):
+                return BoolExpr(bool(lvalue))
+            rvalue = _literal(right)
+            return BoolExpr(bool(rvalue)) if rvalue is not _NOTHING else _as_bool(right)
+        func = _FOLDABLE.get(expr.op)
+        rvalue = _literal(right)
+        if (
+            func is not None
+            and lvalue is not _NOTHING
+            and rvalue is not _NOTHING
+            and not _too_big(expr.op, lvalue, rvalue)
+        ):
+            try:
+                folded = _to_expr(func(lvalue, rvalue))
+            except Exception:
+                folded = None
+            if folded is not None:
+                return folded
+        return replace(expr, left=left, right=right)
+
+    def _fstring(self, expr: FStringExpr) -> Expr:
+        parts: list[str | Expr] = []
+        for part in expr.parts:
+            if not isinstance(part, str):
+                part = self.expr(part)
+                value = _literal(part)
+                if value is not _NOTHING:
+                    part = str(value)
+            if isinstance(part, str) and parts and isinstance(parts[-1], str):
+                parts[-1] += part
+            else:
+                parts.append(part)
+        if all(isinstance(part, str) for part in parts):
+            return StringExpr("".join(parts))  # type: ignore[arg-type]
+        return FStringExpr(parts, line=expr.line, column=expr.column)
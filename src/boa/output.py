@@ -0,0 +1,58 @@
+"""The buffered stream behind `out`.
+
+A `print()` per `out` statement costs a call with keyword handling and two
+writes, and the script's stdout is often line-buffered (a terminal, or a pipe
+under `python -u`), so a loop that emits millions of lines spends most of its
+time in write syscalls. Both engines instead append each line to `STDOUT`,
+which joins the pending lines and writes them to `sys.stdout` in one call once
+they reach its size limit, and on `flush()`.
+
+A run flushes when it ends, normally or with an error, so everything printed
+before a failure appears before its message; `ask` flushes before it prompts,
+and `pfor` before it forks. `run --out-buffer` sets the limit and
+`run --unbuffered` sets it to 0, which writes and flushes every line as it is
+printed.
+"""
+
+from __future__ import annotations
+
+import sys
+from typing import Any
+
+# Characters of pending output before `out` writes them (`run --out-buffer`).
+DEFAULT_OUT_BUFFER = 64 * 1024
+
+
+class OutputBuffer:
+    __slots__ = ("parts", "size", "limit")
+
+    def __init__(self, limit: int = DEFAULT_OUT_BUFFER) -> None:
+        self.parts: list[str] = []
+        self.size = 0
+        self.limit = limit
+
+    def line(self, value: Any) -> None:
+        """Print `value` and a newline, as `print(value)` would."""
+        text = str(value)
+        self.parts.append(text)
+        self.size += len(text) + 1
+        if self.size > self.limit:
+            self.flush()
+
+    def flush(self) -> None:
+        """Write the pending lines to the current `sys.stdout` and flush it."""
+        if self.parts:
+            parts = self.parts
+            self.parts, self.size = [], 0
+            parts.append("")
+            sys.stdout.write("\n".join(parts))
+        sys.stdout.flush()
+
+
+STDOUT = OutputBuffer()
+
+
+def ask(prompt: Any = "") -> str:
+    """The `ask` builtin: `input()`, after the output printed so far."""
+    STDOUT.flush()
+    return input(prompt)
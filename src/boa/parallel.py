@@ -0,0 +1,141 @@
+"""Parallel loops: `pfor` and `par()` on a pool of forked worker processes.
+
+`pfor x ~ items:` runs its iterations on worker processes. Semantic analysis
+only accepts a body whose effects stay inside the iteration: it may not assign
+a name the rest of its scope uses, assign attributes, `break` or `ret` (see
+`semantic`). What each iteration prints with `out` is captured and written in
+item order, so the output is the same as with `for`.
+
+`par(fn, items)` returns `[fn(x) for x in items]` computed the same way, and
+`par(fn, items, op)` reduces the results with `op` (`"+"`, `"*"`, `"min"` or
+`"max"`).
+
+The items are split into chunks whose boundaries depend only on the number of
+items, never on how many workers there are or which finished first. Workers
+are forked, so they start with the program's whole state and nothing has to
+be pickled except chunk bounds and results. Each worker takes the next chunk
+whenever it is idle, so an uneven workload still keeps all of them busy. Each
+chunk is reduced in order by whichever worker ran it, and the partial results
+are then combined in chunk order, so a reduction gives the same value on any
+machine. `$BOA_JOBS` sets the worker count (default: one per CPU). Without
+`fork` (Windows), with one job, or inside a worker, the chunks run in turn in
+the current process.
+"""
+
+from __future__ import annotations
+
+from functools import reduce
+from io import StringIO
+import multiprocessing
+import multiprocessing.pool
+import operator
+import os
+import sys
+from typing import Any, Callable
+
+from .output import STDOUT
+from .runtime import RuntimeErrorBoa
+
+# Upper bound on chunks per loop; enough for uneven chunks to balance out
+# across typical core counts.
+MAX_CHUNKS = 64
+
+_REDUCTIONS: dict[str, tuple[Callable[[Any, Any], Any], Any]] = {
+    "+": (operator.add, 0),
+    "*": (operator.mul, 1),
+    "min": (lambda a, b: b if b < a else a, None),
+    "max": (lambda a, b: b if b > a else a, None),
+}
+
+# `task(start, stop)` of the loop being run; set just before the pool forks,
+# so every worker inherits it.
+_task: Callable[[int, int], Any] | None = None
+_in_worker = False
+
+
+def jobs() -> int:
+    """Worker processes per parallel loop: `$BOA_JOBS`, else one per CPU this process may use."""
+    value = os.environ.get("BOA_JOBS", "")
+    if value.isdigit() and int(value) > 0:
+        return int(value)
+    if hasattr(os, "sched_getaffinity"):
+        return len(os.sched_getaffinity(0))
+    return os.cpu_count() or 1
+
+
+def chunks(count: int) -> list[tuple[int, int]]:
+    """`(start, stop)` of each chunk of `range(count)`; depends on `count` alone."""
+    size = -(-count // MAX_CHUNKS) or 1
+    return [(start, min(start + size, count)) for start in range(0, count, size)]
+
+
+def _run_task(bounds: tuple[int, int]) -> tuple[str, Any, BaseException | None]:
+    global _in_worker
+    _in_worker = True
+    captured = StringIO()
+    stdout = sys.stdout
+    sys.stdout = captured
+    try:
+        result, error = _task(*bounds), None  # type: ignore[misc]
+    except Exception as exc:
+        result, error = None, exc
+    finally:
+        STDOUT.flush()
+        sys.stdout = stdout
+    return captured.getvalue(), result, error
+
+
+def run_chunks(count: int, task: Callable[[int, int], Any], *, sequential: bool = False) -> list[Any]:
+    """Run `task(start, stop)` for every chunk of `range(count)`; returns the results in chunk order.
+
+    Output a chunk prints reaches stdout in chunk order, and an error raised
+    by a chunk is raised here once the output of the chunks before it (and
+    its own, up to the error) has been written.
+    """
+    global _task
+    bounds = chunks(count)
+    workers = min(jobs(), len(bounds))
+    if sequential or workers < 2 or _in_worker or "fork" not in multiprocessing.get_all_start_methods():
+        return [task(start, stop) for start, stop in bounds]
+    STDOUT.flush()
+    _task = task
+    results = []
+    try:
+        with multiprocessing.get_context("fork").Pool(workers) as pool:
+            for text, result, error in pool.imap(_run_task, bounds):
+                sys.stdout.write(text)
+                if error is not None:
+                    raise error
+                results.append(result)
+    except multiprocessing.pool.MaybeEncodingError:
+        raise RuntimeErrorBoa("par() results must be numbers, strings, lists or maps") from None
+    finally:
+        _task = None
+    return results
+
+
+def par_builtin(call: Callable[[Any, list[Any]], Any]) -> Callable[..., Any]:
+    """The `par` builtin of an engine that invokes a Boa callable as `call(fn, args)`."""
+
+    def par(fn: Any, items: Any, op: Any = None) -> Any:
+        if op is not None and (type(op) is not str or op not in _REDUCTIONS):
+            raise RuntimeErrorBoa(f"par() reduction must be one of {' '.join(_REDUCTIONS)}, not {op!r}")
+        values = list(items)
+
+        def task(start: int, stop: int) -> Any:
+            results = [call(fn, [item]) for item in values[start:stop]]
+            if op is None:
+                return results
+            return reduce(_REDUCTIONS[op][0], results)
+
+        parts = run_chunks(len(values), task)
+        if op is None:
+            return [result for part in parts for result in part]
+        combine, empty = _REDUCTIONS[op]
+        if not parts:
+            if empty is None:
+                raise RuntimeErrorBoa(f"par() {op} reduction of an empty list")
+            return empty
+        return reduce(combine, parts)
+
+    return par
@@ -2,19 +2,25 @@
 
 from __future__ import annotations
 
-from dataclasses import dataclass
+from collections.abc import Iterable
+from sys import intern
 
 from .ast_nodes import (
     AssignStmt,
+    AttrAssignStmt,
     AttrExpr,
+    AwaitExpr,
     BinaryExpr,
     BoolExpr,
+    BreakStmt,
     CallExpr,
     ClassDef,
+    ContinueStmt,
     DictExpr,
     Expr,
     ExprStmt,
     ForStmt,
+    FStringExpr,
     FunctionDef,
     IfStmt,
     ListExpr,
@@ -27,23 +33,44 @@ from .ast_nodes import (
     Program,
     ReturnStmt,
     StringExpr,
+    SuperCallExpr,
     UnaryExpr,
     UseStmt,
+    WhileStmt,
 )
-from .lexer import Token, tokenize
+from .lexer import Token, iter_tokens
 
 
-@dataclass
 class _Stream:
-    tokens: list[Token]
-    index: int = 0
+    """Token cursor over a lazy token iterator with one token of lookahead."""
+
+    __slots__ = ("_tokens", "_current", "_next", "in_subclass", "receiver")
+
+    def __init__(self, tokens: Iterable[Token]) -> None:
+        self._tokens = iter(tokens)
+        self._current = next(self._tokens)
+        self._next: Token | None = None
+        # Whether the block being parsed is the body of a class with a base,
+        # and the receiver `super()` binds in the method being parsed.
+        self.in_subclass = False
+        self.receiver: str | None = None
 
     def peek(self) -> Token:
-        return self.tokens[self.index]
+        return self._current
+
+    def peek_next(self) -> Token:
+        if self._next is None:
+            self._next = next(self._tokens, self._current)
+        return self._next
 
     def advance(self) -> Token:
-        tok = self.tokens[self.index]
-        self.index += 1
+        tok = self._current
+        if self._next is not None:
+            self._current = self._next
+            self._next = None
+        else:
+            # EOF repeats once the iterator is exhausted.
+            self._current = next(self._tokens, tok)
         return tok
 
     def match(self, kind: str, value: str | None = None) -> bool:
@@ -84,8 +111,13 @@ PRECEDENCE = {
 }
 
 
-def parse_source(source: str) -> Program:
-    stream = _Stream(tokenize(source))
+def parse_source(source: str | Iterable[str]) -> Program:
+    """Parse a Boa program from a string or any iterable of source lines."""
+    return parse_tokens(iter_tokens(source))
+
+
+def parse_tokens(tokens: Iterable[Token]) -> Program:
+    stream = _Stream(tokens)
     stmts: list = []
     while stream.peek().kind != "EOF":
         if stream.match("NEWLINE"):
@@ -136,16 +168,19 @@ def _parse_stmt(stream: _Stream):
             while stream.match("PUNCT", ","):
                 names.append(stream.expect("IDENT").value)
         stream.expect("NEWLINE")
-        return UseStmt(module, names)
+        return UseStmt(module, names, line=tok.line, column=tok.column)
 
-    if tok.kind == "KEYWORD" and tok.value == "fn":
+    if tok.kind == "KEYWORD" and tok.value in ("fn", "afn", "memo"):
         stream.advance()
+        if tok.value == "memo":
+            # `memo` prefixes a plain `fn`; a coroutine is never memoized.
+            stream.expect("KEYWORD", "fn")
         name = stream.expect("IDENT").value
         stream.expect("PUNCT", "(")
         params: list[Param] = []
         if not stream.match("PUNCT", ")"):
             while True:
-                param_name = stream.expect("IDENT").value
+                param_name = intern(stream.expect("IDENT").value)
                 annotation = None
                 if stream.match("PUNCT", ":"):
                     annotation = _parse_type_text(stream, {("PUNCT", ","), ("PUNCT", ")")})
@@ -157,8 +192,16 @@ def _parse_stmt(stream: _Stream):
         if stream.match("OP", "->"):
             ret_ann = _parse_type_text(stream, {("PUNCT", ":")})
         stream.expect("PUNCT", ":")
-        body = _parse_block(stream)
-        return FunctionDef(name, params, ret_ann, body)
+        outer = stream.in_subclass, stream.receiver
+        stream.receiver = params[0].name if stream.in_subclass and params else None
+        stream.in_subclass = False
+        try:
+            body = _parse_block(stream)
+        finally:
+            stream.in_subclass, stream.receiver = outer
+        return FunctionDef(
+            name, params, ret_ann, body, tok.value == "afn", tok.value == "memo", line=tok.line, column=tok.column
+        )
 
     if tok.kind == "KEYWORD" and tok.value == "cls":
         stream.advance()
@@ -168,23 +211,28 @@ def _parse_stmt(stream: _Stream):
             base_name = stream.expect("IDENT").value
             stream.expect("PUNCT", ")")
         stream.expect("PUNCT", ":")
-        body = _parse_block(stream)
-        return ClassDef(name, base_name, body)
+        outer = stream.in_subclass, stream.receiver
+        stream.in_subclass, stream.receiver = base_name is not None, None
+        try:
+            body = _parse_block(stream)
+        finally:
+            stream.in_subclass, stream.receiver = outer
+        return ClassDef(name, base_name, body, line=tok.line, column=tok.column)
 
     if tok.kind == "KEYWORD" and tok.value == "ret":
         stream.advance()
         if stream.peek().kind == "NEWLINE":
             stream.advance()
-            return ReturnStmt(None)
+            return ReturnStmt(None, line=tok.line, column=tok.column)
         expr = _parse_expr(stream)
         stream.expect("NEWLINE")
-        return ReturnStmt(expr)
+        return ReturnStmt(expr, line=tok.line, column=tok.column)
 
     if tok.kind == "KEYWORD" and tok.value == "out":
         stream.advance()
         expr = _parse_expr(stream)
         stream.expect("NEWLINE")
-        return OutStmt(expr)
+        return OutStmt(expr, line=tok.line, column=tok.column)
 
     if tok.kind == "KEYWORD" and tok.value == "if":
         stream.advance()
@@ -207,37 +255,59 @@ def _parse_stmt(stream: _Stream):
             stream.expect("PUNCT", ":")
             else_body = _parse_block(stream)
 
-        return IfStmt(cond, body, elif_blocks, else_body)
+        return IfStmt(cond, body, elif_blocks, else_body, line=tok.line, column=tok.column)
 
-    if tok.kind == "KEYWORD" and tok.value == "for":
+    if tok.kind == "KEYWORD" and tok.value in ("for", "pfor"):
         stream.advance()
-        name = stream.expect("IDENT").value
+        name = intern(stream.expect("IDENT").value)
         stream.expect("KEYWORD", "~")
         iterable = _parse_expr(stream)
         stream.expect("PUNCT", ":")
         body = _parse_block(stream)
-        return ForStmt(name, iterable, body)
+        return ForStmt(name, iterable, body, tok.value == "pfor", line=tok.line, column=tok.column)
+
+    if tok.kind == "KEYWORD" and tok.value == "while":
+        stream.advance()
+        cond = _parse_expr(stream)
+        stream.expect("PUNCT", ":")
+        body = _parse_block(stream)
+        return WhileStmt(cond, body, line=tok.line, column=tok.column)
+
+    if tok.kind == "KEYWORD" and tok.value == "break":
+        stream.advance()
+        stream.expect("NEWLINE")
+        return BreakStmt(line=tok.line, column=tok.column)
+
+    if tok.kind == "KEYWORD" and tok.value == "continue":
+        stream.advance()
+        stream.expect("NEWLINE")
+        return ContinueStmt(line=tok.line, column=tok.column)
 
-    if tok.kind == "KEYWORD" and tok.value == "..":
+    # The lexer scans `..` as an operator, so match it by value.
+    if tok.kind in ("KEYWORD", "OP") and tok.value == "..":
         stream.advance()
         stream.expect("NEWLINE")
-        return PassStmt()
+        return PassStmt(line=tok.line, column=tok.column)
 
     if tok.kind == "IDENT":
-        look = stream.tokens[stream.index + 1]
+        look = stream.peek_next()
         if (look.kind == "OP" and look.value == "=") or (look.kind == "PUNCT" and look.value == ":"):
-            name = stream.advance().value
+            name = intern(stream.advance().value)
             annotation = None
             if stream.match("PUNCT", ":"):
                 annotation = _parse_type_text(stream, {("OP", "=")})
             stream.expect("OP", "=")
             expr = _parse_expr(stream)
             stream.expect("NEWLINE")
-            return AssignStmt(name, annotation, expr)
+            return AssignStmt(name, annotation, expr, line=tok.line, column=tok.column)
 
     expr = _parse_expr(stream)
+    if isinstance(expr, AttrExpr) and stream.match("OP", "="):
+        value = _parse_expr(stream)
+        stream.expect("NEWLINE")
+        return AttrAssignStmt(expr.target, expr.name, value, line=tok.line, column=tok.column)
     stream.expect("NEWLINE")
-    return ExprStmt(expr)
+    return ExprStmt(expr, line=tok.line, column=tok.column)
 
 
 def _parse_expr(stream: _Stream, min_prec: int = 1) -> Expr:
@@ -246,13 +316,13 @@ def _parse_expr(stream: _Stream, min_prec: int = 1) -> Expr:
         tok = stream.peek()
         if tok.kind not in {"OP", "KEYWORD"}:
             break
-        op = tok.value
+        op = intern(tok.value)
         prec = PRECEDENCE.get(op)
         if prec is None or prec < min_prec:
             break
         stream.advance()
         right = _parse_expr(stream, prec + 1)
-        left = BinaryExpr(left, op, right)
+        left = BinaryExpr(left, op, right, line=tok.line, column=tok.column)
     return left
 
 
@@ -260,52 +330,69 @@ def _parse_unary(stream: _Stream) -> Expr:
     tok = stream.peek()
     if tok.kind == "OP" and tok.value in {"-", "!"}:
         op = stream.advance().value
-        return UnaryExpr(op, _parse_unary(stream))
+        return UnaryExpr(op, _parse_unary(stream), line=tok.line, column=tok.column)
+    if tok.kind == "KEYWORD" and tok.value == "aw":
+        stream.advance()
+        return AwaitExpr(_parse_unary(stream), line=tok.line, column=tok.column)
     return _parse_postfix(stream)
 
 
 def _parse_postfix(stream: _Stream) -> Expr:
     expr = _parse_primary(stream)
     while True:
+        tok = stream.peek()
         if stream.match("PUNCT", "("):
-            args: list[Expr] = []
-            if not stream.match("PUNCT", ")"):
-                while True:
-                    args.append(_parse_expr(stream))
-                    if stream.match("PUNCT", ")"):
-                        break
-                    stream.expect("PUNCT", ",")
-            expr = CallExpr(expr, args)
+            expr = CallExpr(expr, _parse_args(stream), line=tok.line, column=tok.column)
             continue
         if stream.match("PUNCT", "."):
-            name = stream.expect("IDENT").value
-            expr = AttrExpr(expr, name)
+            name = stream.expect("IDENT")
+            expr = AttrExpr(expr, intern(name.value), line=name.line, column=name.column)
             continue
         break
     return expr
 
 
+def _parse_args(stream: _Stream) -> list[Expr]:
+    """The arguments of a call whose `(` was just consumed, through its `)`."""
+    args: list[Expr] = []
+    if not stream.match("PUNCT", ")"):
+        while True:
+            args.append(_parse_expr(stream))
+            if stream.match("PUNCT", ")"):
+                break
+            stream.expect("PUNCT", ",")
+    return args
+
+
 def _parse_primary(stream: _Stream) -> Expr:
     tok = stream.advance()
     if tok.kind == "NUMBER":
         if "." in tok.value:
-            return NumberExpr(float(tok.value))
-        return NumberExpr(int(tok.value))
+            return NumberExpr(float(tok.value), line=tok.line, column=tok.column)
+        return NumberExpr(int(tok.value), line=tok.line, column=tok.column)
     if tok.kind == "STRING":
-        is_f = tok.value.startswith("f")
-        value = tok.value[1:] if is_f else tok.value
-        return StringExpr(value, is_f)
+        return StringExpr(tok.value, line=tok.line, column=tok.column)
+    if tok.kind == "FSTRING":
+        return _parse_fstring(tok.value, tok, stream)
     if tok.kind == "IDENT":
-        return NameExpr(tok.value)
+        if tok.value == "super" and stream.peek().kind == "PUNCT" and stream.peek().value == "(":
+            # `super()` only ever prefixes a method call on the base class.
+            stream.advance()
+            stream.expect("PUNCT", ")")
+            stream.expect("PUNCT", ".")
+            name = intern(stream.expect("IDENT").value)
+            stream.expect("PUNCT", "(")
+            return SuperCallExpr(name, _parse_args(stream), stream.receiver, line=tok.line, column=tok.column)
+        return NameExpr(intern(tok.value), line=tok.line, column=tok.column)
     if tok.kind == "KEYWORD" and tok.value == "ask":
         arg = _parse_primary(stream)
-        return CallExpr(NameExpr("ask"), [arg])
+        return CallExpr(NameExpr("ask", line=tok.line, column=tok.column), [arg], line=tok.line, column=tok.column)
     if tok.kind == "KEYWORD" and tok.value == "yes":
-        return BoolExpr(True)
+        return BoolExpr(True, line=tok.line, column=tok.column)
     if tok.kind == "KEYWORD" and tok.value == "no":
-        return BoolExpr(False)
+        return BoolExpr(False, line=tok.line, column=tok.column)
     if tok.kind == "KEYWORD" and tok.value == "nil":
-        return NilExpr()
+        return NilExpr(line=tok.line, column=tok.column)
     if tok.kind == "PUNCT" and tok.value == "(":
         expr = _parse_expr(stream)
         stream.expect("PUNCT", ")")
@@ -318,7 +405,7 @@ def _parse_primary(stream: _Stream) -> Expr:
                 if stream.match("PUNCT", "]"):
                     break
                 stream.expect("PUNCT", ",")
-        return ListExpr(elements)
+        return ListExpr(elements, line=tok.line, column=tok.column)
     if tok.kind == "PUNCT" and tok.value == "{":
         entries: list[tuple[Expr, Expr]] = []
         if not stream.match("PUNCT", "}"):
@@ -330,6 +417,83 @@ def _parse_primary(stream: _Stream) -> Expr:
                 if stream.match("PUNCT", "}"):
                     break
                 stream.expect("PUNCT", ",")
-        return DictExpr(entries)
+        return DictExpr(entries, line=tok.line, column=tok.column)
 
     raise ValueError(f"Unexpected token {tok.kind}:{tok.value} at {tok.line}:{tok.column}")
+
+
+def _parse_fstring(template: str, tok: Token, outer: _Stream) -> Expr:
+    """Split an f-string into literal text and parsed `{expr}` fields once.
+
+    `{{` and `}}` stand for literal braces. Field text is a full Boa
+    expression, so `{s.name}` or `{len(xs) + 1}` work the same as in code.
+    """
+    parts: list[str | Expr] = []
+    text: list[str] = []
+    i = 0
+    while i < len(template):
+        ch = template[i]
+        if ch in "{}" and template[i : i + 2] == ch * 2:
+            text.append(ch)
+            i += 2
+            continue
+        if ch == "}":
+            raise ValueError(f"Single '}}' in f-string at {tok.line}:{tok.column}")
+        if ch != "{":
+            text.append(ch)
+            i += 1
+            continue
+        end = _fstring_field_end(template, i + 1)
+        if end < 0:
+            raise ValueError(f"Unterminated '{{' in f-string at {tok.line}:{tok.column}")
+        field = template[i + 1 : end]
+        source = field.strip()
+        if not source:
+            raise ValueError(f"Empty expression in f-string at {tok.line}:{tok.column}")
+        if text:
+            parts.append("".join(text))
+            text = []
+        # Column of the field's first character, past the opening quote.
+        start = tok.column + i + 2 + len(field) - len(field.lstrip())
+        parts.append(_parse_fstring_field(source, tok, start, outer))
+        i = end + 1
+    if text:
+        parts.append("".join(text))
+    if all(isinstance(part, str) for part in parts):
+        return StringExpr("".join(parts), line=tok.line, column=tok.column)
+    return FStringExpr(parts, line=tok.line, column=tok.column)
+
+
+def _fstring_field_end(template: str, start: int) -> int:
+    depth = 0
+    quote = ""
+    for i in range(start, len(template)):
+        ch = template[i]
+        if quote:
+            if ch == quote:
+                quote = ""
+        elif ch in "\"'":
+            quote = ch
+        elif ch in "([{":
+            depth += 1
+        elif ch in ")]}":
+            if ch == "}" and depth == 0:
+                return i
+            depth -= 1
+    return -1
+
+
+def _parse_fstring_field(source: str, tok: Token, start: int, outer: _Stream) -> Expr:
+    # The field is lexed on its own; move its tokens to where it sits in the file.
+    tokens = (Token(t.kind, t.value, tok.line, start + t.column - 1) for t in iter_tokens(source))
+    try:
+        stream = _Stream(tokens)
+        # A field in a method body sees the same `super()` receiver as its code.
+        stream.in_subclass = outer.in_subclass
+        stream.receiver = outer.receiver
+        expr = _parse_expr(stream)
+        stream.expect("NEWLINE")
+        stream.expect("EOF")
+    except (ValueError, IndexError) as exc:
+        raise ValueError(f"Invalid f-string expression '{source}' at {tok.line}:{tok.column}") from exc
+    return expr
@@ -0,0 +1,137 @@
+"""Phase, function and line profiler behind `boa run --profile`.
+
+`profile_source` runs the pipeline once, timing every phase, and executes a
+profiling build of the program: the bytecode compiler emits PROFILE_* events
+(the tree-walker calls the same hooks from `_call_function`), so ordinary runs
+carry no instrumentation at all. Function times are inclusive (the whole
+call) and exclusive (minus callees); recursive calls count inclusive time
+once, at the outermost activation. Exclusive time is also aggregated per call
+stack and written in the collapsed format `flamegraph.pl` and speedscope read:
+one `outer;inner <microseconds>` line per distinct stack.
+"""
+
+from __future__ import annotations
+
+from collections.abc import Iterator
+import contextlib
+from pathlib import Path
+import time
+from typing import Any
+
+from .bytecode import compile_program
+from .lexer import tokenize
+from .optimizer import DEFAULT_LEVEL, optimize
+from .parser import parse_tokens
+from .runtime import eval_program
+from .semantic import analyze
+from .vm import run_code
+
+
+class FunctionStats:
+    __slots__ = ("calls", "inclusive", "exclusive")
+
+    def __init__(self) -> None:
+        self.calls = 0
+        self.inclusive = 0.0
+        self.exclusive = 0.0
+
+
+class Profiler:
+    def __init__(self, clock: Any = time.perf_counter) -> None:
+        self.clock = clock
+        self.phases: dict[str, float] = {}
+        self.functions: dict[str, FunctionStats] = {}
+        self.lines: dict[int, int] = {}
+        self.stacks: dict[str, float] = {}
+        # One `[name, stack path, start, callee seconds]` per live activation.
+        self._frames: list[list[Any]] = []
+        self._depth: dict[str, int] = {}
+
+    @contextlib.contextmanager
+    def phase(self, name: str) -> Iterator[None]:
+        start = self.clock()
+        try:
+            yield
+        finally:
+            self.phases[name] = self.phases.get(name, 0.0) + self.clock() - start
+
+    def enter(self, name: str) -> None:
+        path = f"{self._frames[-1][1]};{name}" if self._frames else name
+        self._depth[name] = self._depth.get(name, 0) + 1
+        self._frames.append([name, path, self.clock(), 0.0])
+
+    def exit(self) -> None:
+        name, path, start, callees = self._frames.pop()
+        elapsed = self.clock() - start
+        stats = self.functions.get(name)
+        if stats is None:
+            stats = self.functions[name] = FunctionStats()
+        stats.calls += 1
+        stats.exclusive += elapsed - callees
+        depth = self._depth[name] - 1
+        self._depth[name] = depth
+        if not depth:
+            stats.inclusive += elapsed
+        self.stacks[path] = self.stacks.get(path, 0.0) + elapsed - callees
+        if self._frames:
+            self._frames[-1][3] += elapsed
+
+    def line(self, lineno: int) -> None:
+        lines = self.lines
+        lines[lineno] = lines.get(lineno, 0) + 1
+
+    def collapsed(self) -> str:
+        rows = [f"{path} {round(seconds * 1e6)}" for path, seconds in sorted(self.stacks.items())]
+        return "\n".join(rows) + "\n" if rows else ""
+
+    def report(self, source: str | None = None, limit: int = 20) -> str:
+        out = ["phase            ms"]
+        for name, seconds in self.phases.items():
+            out.append(f"{name:<10}{seconds * 1000:>10.2f}")
+
+        out.append("")
+        out.append(f"{'calls':>10}{'incl ms':>12}{'excl ms':>12}{'us/call':>10}  function")
+        ranked = sorted(self.functions.items(), key=lambda item: item[1].exclusive, reverse=True)
+        for name, stats in ranked[:limit]:
+            per_call = stats.inclusive / stats.calls * 1e6
+            out.append(
+                f"{stats.calls:>10}{stats.inclusive * 1000:>12.2f}"
+                f"{stats.exclusive * 1000:>12.2f}{per_call:>10.1f}  {name}"
+            )
+
+        out.append("")
+        out.append(f"{'hits':>10}{'line':>6}  source")
+        text = source.splitlines() if source is not None else []
+        hot = sorted(self.lines.items(), key=lambda item: (-item[1], item[0]))
+        for lineno, hits in hot[:limit]:
+            snippet = text[lineno - 1].strip() if 0 < lineno <= len(text) else ""
+            out.append(f"{hits:>10}{lineno:>6}  {snippet}")
+        return "\n".join(out)
+
+
+def profile_source(
+    source: str, engine: str = "vm", opt_level: int = DEFAULT_LEVEL, loader: Any = None
+) -> Profiler:
+    """Run `source` once under the profiler and return the collected data."""
+    profiler = Profiler()
+    with profiler.phase("lex"):
+        tokens = tokenize(source)
+    with profiler.phase("parse"):
+        program = parse_tokens(tokens)
+    with profiler.phase("analyze"):
+        analyze(program)
+    with profiler.phase("optimize"):
+        program = optimize(program, opt_level)
+    if engine == "tree":
+        with profiler.phase("execute"):
+            eval_program(program, profiler=profiler, loader=loader)
+        return profiler
+    with profiler.phase("compile"):
+        code = compile_program(program, profile=True)
+    with profiler.phase("execute"):
+        run_code(code, profiler=profiler, loader=loader)
+    return profiler
+
+
+def write_collapsed(profiler: Profiler, path: str | Path) -> None:
+    Path(path).write_text(profiler.collapsed(), encoding="utf-8")
@@ -2,21 +2,29 @@
 
 from __future__ import annotations
 
-from dataclasses import dataclass
-import re
+from collections.abc import Callable, Generator
+from dataclasses import dataclass, field
+import inspect
+import sys
 from typing import Any
 
+from .arrays import TYPECODES, pack
 from .ast_nodes import (
     AssignStmt,
+    AttrAssignStmt,
     AttrExpr,
+    AwaitExpr,
     BinaryExpr,
     BoolExpr,
+    BreakStmt,
     CallExpr,
     ClassDef,
+    ContinueStmt,
     DictExpr,
     Expr,
     ExprStmt,
     ForStmt,
+    FStringExpr,
     FunctionDef,
     IfStmt,
     ListExpr,
@@ -27,25 +35,71 @@ from .ast_nodes import (
     PassStmt,
     Program,
     ReturnStmt,
+    Stmt,
     StringExpr,
+    SuperCallExpr,
     UnaryExpr,
     UseStmt,
+    WhileStmt,
+    span_column,
+    span_line,
 )
+from .defaults import DEFAULT_MAX_STACK
+from .memo import MISSING, MemoCache, memo_key
+from .memstats import POOL_SIZE, STATS
+from .output import DEFAULT_OUT_BUFFER, STDOUT, ask
+from .scopes import instance_layout
 
 
 class RuntimeErrorBoa(RuntimeError):
-    pass
+    # Packed position (`ast_nodes.pack_span`) of the innermost node that was
+    # running, filled in by whichever engine the error propagates through.
+    span = 0
 
+    def __str__(self) -> str:
+        message = super().__str__()
+        if not self.span:
+            return message
+        return f"{message} at {span_line(self.span)}:{span_column(self.span)}"
+
+
+class _Return:
+    """Completion record for a `ret`; `_exec_stmt` returns it instead of raising."""
+
+    __slots__ = ("value",)
 
-class _ReturnSignal(Exception):
     def __init__(self, value: Any) -> None:
         self.value = value
 
 
+class _TailCall:
+    """Completion record for `ret f(...)`: `_call_function` runs the call in place."""
+
+    __slots__ = ("function", "args", "receiver")
+
+    def __init__(self, function: BoaFunction, args: list[Any], receiver: Any) -> None:
+        self.function = function
+        self.args = args
+        self.receiver = receiver
+
+
+class _LoopControl:
+    """Completion record for `break`/`continue`, consumed by the innermost loop."""
+
+    __slots__ = ()
+
+
+_BREAK = _LoopControl()
+_CONTINUE = _LoopControl()
+
+
 class Env:
+    __slots__ = ("parent", "values")
+
     def __init__(self, parent: Env | None = None) -> None:
         self.parent = parent
         self.values: dict[str, Any] = {}
+        STATS.frames += 1
 
     def get(self, name: str) -> Any:
         if name in self.values:
@@ -58,113 +112,528 @@ class Env:
         self.values[name] = value
 
 
-@dataclass
+@dataclass(slots=True)
 class BoaFunction:
     name: str
     params: list[str]
     body: list
     closure: Env
+    is_async: bool = False
+    # The results of a `memo fn`, else None.
+    memo: MemoCache | None = None
+    # No `fn` or `cls` in the body can capture a call's `Env`, so it goes
+    # back to the pool when the call returns (see `memstats`).
+    pooled: bool = False
 
 
 @dataclass
 class BoaClass:
     name: str
-    methods: dict[str, BoaFunction]
+    # Every method of the class, inherited ones included (see `make_class`).
+    # The table never changes once the class exists, so the class object
+    # itself is the version an inline cache checks.
+    methods: dict[str, Any]
+    # Slot index of every field `__init__` assigns (see `scopes.instance_layout`),
+    # the base class's fields first.
+    layout: dict[str, int] = field(default_factory=dict)
+    base: BoaClass | None = None
+
+
+def class_base(name: str, value: Any) -> BoaClass:
+    """Check `value`, what the header of class `name` names as its base."""
+    if type(value) is not BoaClass:
+        raise RuntimeErrorBoa(f"Base of class '{name}' must be a class, not {type(value).__name__}")
+    return value
+
+
+def make_class(name: str, base: BoaClass | None, methods: dict[str, Any], fields: list[str]) -> BoaClass:
+    """Class `name` with `methods` and `fields` of its own on top of those of `base`.
+
+    The method resolution order is flattened here, once: the class copies its
+    base's (already flattened) method table and overrides it with its own, so
+    a lookup is one dict probe however deep the hierarchy, and an instance
+    keeps its base's fields at the same slots its base's own instances use.
+    """
+    if base is None:
+        return BoaClass(name, methods, {field: slot for slot, field in enumerate(fields)})
+    layout = dict(base.layout)
+    for field_name in fields:
+        layout.setdefault(field_name, len(layout))
+    return BoaClass(name, {**base.methods, **methods}, layout, base)
+
+
+def super_method(base: BoaClass, name: str) -> Any:
+    """The method `super().name(...)` calls in a method of a class whose base is `base`."""
+    method = base.methods.get(name)
+    if method is None:
+        raise RuntimeErrorBoa(f"Base class '{base.name}' has no method '{name}'")
+    return method
+
+
+class BoaModule:
+    """A namespace bound by `use`; members are read with attribute syntax.
+
+    A module given `load` instead of `values` is lazy: `load` runs on the
+    first member access, so an import that is never used costs nothing.
+    """
+
+    __slots__ = ("name", "_values", "_load")
+
+    def __init__(
+        self,
+        name: str,
+        values: dict[str, Any] | None = None,
+        load: Callable[[], dict[str, Any]] | None = None,
+    ) -> None:
+        self.name = name
+        self._values = values
+        self._load = load
+
+    @property
+    def loaded(self) -> bool:
+        return self._values is not None
+
+    def member(self, name: str) -> Any:
+        values = self._values
+        if values is None:
+            values = self._values = self._load()
+        try:
+            return values[name]
+        except KeyError:
+            raise RuntimeErrorBoa(f"Module '{self.name}' has no member '{name}'") from None
+
+    def __repr__(self) -> str:
+        return f"<module {self.name}>"
+
+
+class BoaCoroutine:
+    """The result of calling an `afn`; `aw` runs it (see `scheduler`)."""
+
+    __slots__ = ("name", "steps", "awaited")
+
+    def __init__(self, name: str, steps: Generator[Any, Any, Any]) -> None:
+        self.name = name
+        # Runs the body, yielding each native awaitable it waits on.
+        self.steps = steps
+        self.awaited = False
+
+    def __repr__(self) -> str:
+        return f"<coroutine {self.name}>"
+
+
+def await_value(value: Any) -> Generator[Any, Any, Any]:
+    """The `aw` operation of both engines: `result = yield from await_value(x)`."""
+    if type(value) is BoaCoroutine:
+        if value.awaited:
+            raise RuntimeErrorBoa(f"Coroutine '{value.name}' was already awaited")
+        value.awaited = True
+        return (yield from value.steps)
+    if inspect.isawaitable(value):
+        return (yield value)
+    raise RuntimeErrorBoa(f"Cannot await a value of type {type(value).__name__}")
+
+
+def native_module(name: str) -> BoaModule | None:
+    """The module built into the runtime under `name`, if any."""
+    if name == "asyncio":
+        # Deferred so programs that never `use asyncio` skip loading it.
+        from . import scheduler
+
+        return scheduler.module()
+    return None
+
+
+def _unknown_module(name: str) -> dict[str, Any]:
+    raise RuntimeErrorBoa(f"Unknown module '{name}'")
+
+
+def import_module(name: str, loader: Any = None) -> BoaModule:
+    """The module `use name` binds: a built-in one, else the Boa module `loader` finds.
+
+    `loader` is a `modules.ModuleLoader`; without one only built-in modules
+    exist. Either way a missing module is reported on first member access.
+    """
+    module = native_module(name)
+    if module is not None:
+        return module
+    if loader is None:
+        return BoaModule(name, load=lambda: _unknown_module(name))
+    return loader.module(name)
+
+
+def use_values(stmt: UseStmt, module: BoaModule) -> list[tuple[str, Any]]:
+    """`(name, value)` for each binding `stmt` makes from `module`."""
+    if stmt.names is None:
+        return [(stmt.module, module)]
+    return [(name, module.member(name)) for name in stmt.names]
+
+
+class _NoField:
+    __slots__ = ()
+
+    def __repr__(self) -> str:
+        return "<no field>"
+
+
+# Marks a layout slot the instance has not assigned yet.
+NO_FIELD = _NoField()
 
 
-@dataclass
 class BoaInstance:
-    cls: BoaClass
-    fields: dict[str, Any]
+    __slots__ = ("cls", "values", "extra")
+
+    def __init__(self, cls: BoaClass) -> None:
+        self.cls = cls
+        # Layout fields live in a fixed slot array; attributes assigned outside
+        # `__init__` go to `extra`, which most instances never allocate.
+        self.values: list[Any] = [NO_FIELD] * len(cls.layout)
+        self.extra: dict[str, Any] | None = None
+        STATS.instances += 1
+
+    @property
+    def fields(self) -> dict[str, Any]:
+        found = {name: self.values[slot] for name, slot in self.cls.layout.items()}
+        found = {name: value for name, value in found.items() if value is not NO_FIELD}
+        if self.extra:
+            found.update(self.extra)
+        return found
+
+    def __repr__(self) -> str:
+        return f"<{self.cls.name} instance>"
+
+
+class BoundMethod:
+    __slots__ = ("function", "receiver")
+
+    def __init__(self, function: Any, receiver: BoaInstance) -> None:
+        self.function = function
+        self.receiver = receiver
+
+    def __repr__(self) -> str:
+        return f"<bound fn {self.function.name}>"
+
+
+def resolve_member(inst: BoaInstance, name: str, site: list[Any]) -> tuple[Any, Any]:
+    """Look `name` up on `inst`, returning `(field value, None)` or `(None, method)`.
+
+    This is the slow path of both engines' inline caches: it refills `site`
+    with `[class, slot, None]` for a layout field or `[class, -1, method]` for
+    a method, so the next access from the same site on an instance of the same
+    class is a single identity check.
+    """
+    cls = inst.cls
+    slot = cls.layout.get(name)
+    if slot is not None:
+        site[0], site[1], site[2] = cls, slot, None
+        value = inst.values[slot]
+        if value is not NO_FIELD:
+            return value, None
+    elif inst.extra is not None and name in inst.extra:
+        return inst.extra[name], None
+    method = cls.methods.get(name)
+    if method is None:
+        raise RuntimeErrorBoa(f"Unknown member '{name}'")
+    if slot is None:
+        # Only cache methods no layout field can shadow later.
+        site[0], site[1], site[2] = cls, -1, method
+    return None, method
+
+
+def store_member(target: Any, name: str, value: Any, site: list[Any]) -> None:
+    if not isinstance(target, BoaInstance):
+        raise RuntimeErrorBoa("Attribute assignment supported only on instances")
+    cls = target.cls
+    slot = cls.layout.get(name)
+    if slot is not None:
+        site[0], site[1], site[2] = cls, slot, None
+        target.values[slot] = value
+        return
+    if target.extra is None:
+        target.extra = {}
+    target.extra[name] = value
 
 
-def _boa_range(*args: Any) -> list[int]:
+def _boa_range(*args: Any) -> range:
+    # A lazy range: iteration, `~` and len() never materialize the elements.
     try:
-        ints = [int(a) for a in args]
+        return range(*(int(a) for a in args))
     except (TypeError, ValueError) as exc:
         raise RuntimeErrorBoa("range() arguments must be integers") from exc
-    return list(range(*ints))
-
-
-def _eval_fstring(value: str, env: Env) -> str:
-    def repl(match: re.Match[str]) -> str:
-        name = match.group(1).strip()
-        return str(env.get(name))
-
-    return re.sub(r"\{([A-Za-z_][A-Za-z0-9_]*)\}", repl, value)
 
 
 def _truthy(value: Any) -> bool:
     return bool(value)
 
 
-def eval_program(program: Program, env: Env | None = None) -> Env:
+def install_builtins(env: Env, call: Callable[[Any, list[Any]], Any] | None = None) -> None:
+    """Bind the builtins in `env`; `call(fn, args)` invokes a Boa callable for `par`."""
+    # Deferred because these modules raise this module's RuntimeErrorBoa.
+    from .files import BUILTINS as FILE_BUILTINS
+    from .parallel import par_builtin
+    from .vectors import BUILTINS
+
+    env.set("ask", ask)
+    env.set("len", len)
+    env.set("range", _boa_range)
+    env.values.update(BUILTINS)
+    env.values.update(FILE_BUILTINS)
+    env.set("par", par_builtin(call or _call_value))
+
+
+# Host frames a single Boa call can nest in the tree-walker (`_eval_expr` ->
+# `_call_value` -> `_call_function` -> `_exec_block` -> `_exec_stmt` -> ...),
+# with headroom for nested expressions and blocks.
+_HOST_FRAMES_PER_CALL = 16
+
+# Active profiler of the current `eval_program` call, or None.
+_profiler: Any = None
+# Resolves the current run's `use` statements (see `import_module`).
+_loader: Any = None
+# Call depth limit of the current run, the depth reached so far, and the
+# deepest it has been.
+_max_stack = DEFAULT_MAX_STACK
+_depth = 0
+_peak_depth = 0
+# Finished call frames, reused by the next calls (see `memstats`).
+_free_envs: list[Env] = []
+# Binds a subclass's base in the `Env` its methods close over; not a name a
+# program can spell.
+_SUPER = "<super>"
+# Inline caches of the current run's attribute sites, by node id:
+# `[class, slot, method, node]` (see `resolve_member`). Holding the node keeps
+# its id from being reused while the entry lives.
+_sites: dict[int, list[Any]] = {}
+
+
+def _site(node: AttrExpr | AttrAssignStmt) -> list[Any]:
+    site = _sites[id(node)] = [None, -1, None, node]
+    return site
+
+
+def eval_program(
+    program: Program,
+    env: Env | None = None,
+    profiler: Any = None,
+    max_stack: int = DEFAULT_MAX_STACK,
+    loader: Any = None,
+    out_buffer: int = DEFAULT_OUT_BUFFER,
+) -> Env:
+    global _profiler, _max_stack, _depth, _peak_depth, _loader
     runtime = env or Env()
-    runtime.set("ask", input)
-    runtime.set("len", len)
-    runtime.set("range", _boa_range)
-    _exec_block(program.statements, runtime)
+    install_builtins(runtime)
+    # The tree-walker recurses on the host stack, so make room for
+    # `max_stack` Boa calls; tail calls never nest (see `_call_function`).
+    host_limit = sys.getrecursionlimit()
+    sys.setrecursionlimit(max(host_limit, max_stack * _HOST_FRAMES_PER_CALL))
+    _max_stack, _depth, _peak_depth = max_stack, 0, 0
+    _profiler = profiler
+    _loader = loader
+    STDOUT.limit = out_buffer
+    try:
+        if profiler is None:
+            _exec_block(program.statements, runtime)
+        else:
+            profiler.enter("<module>")
+            try:
+                _exec_block(program.statements, runtime)
+            finally:
+                profiler.exit()
+    except RecursionError:
+        # Deeply nested expressions can still exhaust the host stack first.
+        raise _stack_overflow(max_stack) from None
+    finally:
+        STDOUT.flush()
+        STDOUT.limit = DEFAULT_OUT_BUFFER
+        _profiler = None
+        _loader = None
+        _max_stack = DEFAULT_MAX_STACK
+        _sites.clear()
+        sys.setrecursionlimit(host_limit)
     return runtime
 
 
-def _exec_block(stmts: list, env: Env) -> None:
+def exec_module(program: Program, env: Env) -> None:
+    """Run the body of a module imported by the current `eval_program` run into `env`."""
+    install_builtins(env)
+    _exec_block(program.statements, env)
+
+
+def _stack_overflow(max_stack: int) -> RuntimeErrorBoa:
+    return RuntimeErrorBoa(f"Maximum call depth exceeded ({max_stack} frames; raise it with --max-stack)")
+
+
+def _exec_block(stmts: list, env: Env) -> _Return | _LoopControl | None:
+    # Statements complete normally (None) or with a completion record that
+    # every enclosing block hands straight back up to `_call_function` (or,
+    # for `break`/`continue`, to the innermost loop).
     for stmt in stmts:
-        _exec_stmt(stmt, env)
+        if _profiler is not None:
+            _profiler.line(stmt.line)
+        try:
+            completion = _exec_stmt(stmt, env)
+        except RuntimeErrorBoa as exc:
+            _locate(exc, stmt)
+            raise
+        if completion is not None:
+            return completion
+    return None
+
 
+def _locate(exc: RuntimeErrorBoa, node: Stmt | Expr) -> None:
+    if not exc.span and node.line:
+        exc.span = node.span
 
-def _exec_stmt(stmt, env: Env) -> None:
+
+def _exec_stmt(stmt, env: Env) -> _Return | _LoopControl | None:
     if isinstance(stmt, UseStmt):
+        for name, value in use_values(stmt, import_module(stmt.module, _loader)):
+            env.set(name, value)
         return
     if isinstance(stmt, FunctionDef):
-        env.set(stmt.name, BoaFunction(stmt.name, [p.name for p in stmt.params], stmt.body, env))
+        env.set(stmt.name, _function(stmt, env))
         return
     if isinstance(stmt, ClassDef):
         methods: dict[str, BoaFunction] = {}
         temp = Env(env)
+        base = None
+        if stmt.base_name is not None:
+            # Resolved once here for every `super()` call of the methods.
+            base = temp.values[_SUPER] = class_base(stmt.name, env.get(stmt.base_name))
         for child in stmt.body:
             if isinstance(child, FunctionDef):
-                fn = BoaFunction(child.name, [p.name for p in child.params], child.body, temp)
-                methods[child.name] = fn
-        env.set(stmt.name, BoaClass(stmt.name, methods))
+                methods[child.name] = _function(child, temp)
+        env.set(stmt.name, make_class(stmt.name, base, methods, instance_layout(stmt)))
         return
     if isinstance(stmt, ReturnStmt):
-        value = None if stmt.value is None else _eval_expr(stmt.value, env)
-        raise _ReturnSignal(value)
+        value = stmt.value
+        if isinstance(value, CallExpr) and _profiler is None:
+            return _tail_call(value, env)
+        return _Return(None if value is None else _eval_expr(value, env))
     if isinstance(stmt, AssignStmt):
-        env.set(stmt.name, _eval_expr(stmt.value, env))
+        value = _eval_expr(stmt.value, env)
+        if stmt.annotation in TYPECODES:
+            value = pack(value, stmt.annotation)
+        env.set(stmt.name, value)
         return
     if isinstance(stmt, ExprStmt):
         _eval_expr(stmt.expr, env)
         return
     if isinstance(stmt, OutStmt):
-        print(_eval_expr(stmt.expr, env))
+        STDOUT.line(_eval_expr(stmt.expr, env))
+        return
+    if isinstance(stmt, AttrAssignStmt):
+        target = _eval_expr(stmt.target, env)
+        value = _eval_expr(stmt.value, env)
+        site = _sites.get(id(stmt)) or _site(stmt)
+        if type(target) is BoaInstance and target.cls is site[0]:
+            target.values[site[1]] = value
+        else:
+            store_member(target, stmt.name, value, site)
         return
+    # Blocks share their function's scope, so assignments inside `if`/`for`
+    # bodies stay visible afterwards (the VM resolves names the same way).
     if isinstance(stmt, IfStmt):
         if _truthy(_eval_expr(stmt.condition, env)):
-            _exec_block(stmt.body, Env(env))
-            return
+            return _exec_block(stmt.body, env)
         for cond, block in stmt.elif_blocks:
             if _truthy(_eval_expr(cond, env)):
-                _exec_block(block, Env(env))
-                return
+                return _exec_block(block, env)
         if stmt.else_body is not None:
-            _exec_block(stmt.else_body, Env(env))
-        return
+            return _exec_block(stmt.else_body, env)
+        return None
     if isinstance(stmt, ForStmt):
+        if stmt.parallel:
+            return _exec_pfor(stmt, env)
         iterable = _eval_expr(stmt.iterable, env)
+        # Blocks share the function's scope, so every iteration rebinds the
+        # same entry; store it directly rather than through `Env.set`.
+        values, name = env.values, stmt.var_name
         for item in iterable:
-            inner = Env(env)
-            inner.set(stmt.var_name, item)
-            _exec_block(stmt.body, inner)
-        return
+            values[name] = item
+            completion = _exec_block(stmt.body, env)
+            if completion is not None:
+                if completion is _BREAK:
+                    break
+                if completion is not _CONTINUE:
+                    return completion
+        return None
+    if isinstance(stmt, WhileStmt):
+        while _truthy(_eval_expr(stmt.condition, env)):
+            completion = _exec_block(stmt.body, env)
+            if completion is not None:
+                if completion is _BREAK:
+                    break
+                if completion is not _CONTINUE:
+                    return completion
+        return None
+    if isinstance(stmt, BreakStmt):
+        return _BREAK
+    if isinstance(stmt, ContinueStmt):
+        return _CONTINUE
     if isinstance(stmt, PassStmt):
         return
 
     raise RuntimeErrorBoa(f"Unsupported statement {type(stmt).__name__}")
 
 
-def _call_function(fn: BoaFunction, args: list[Any], bound_self: Any | None = None) -> Any:
-    local = Env(fn.closure)
+def _exec_pfor(stmt: ForStmt, env: Env) -> None:
+    from .parallel import run_chunks
+
+    # Semantic analysis keeps every binding the body makes private to the
+    # iteration, so a worker's `env` is never read again (see `parallel`).
+    items = list(_eval_expr(stmt.iterable, env))
+    values, name, body = env.values, stmt.var_name, stmt.body
+
+    def task(start: int, stop: int) -> None:
+        for item in items[start:stop]:
+            values[name] = item
+            _exec_block(body, env)
+
+    run_chunks(len(items), task, sequential=_profiler is not None)
+
+
+def _function(stmt: FunctionDef, env: Env) -> BoaFunction:
+    # Parameters annotated `[i]`/`[f]` are packed by a prologue of annotated
+    # self-assignments, like the VM's, so other calls pay nothing for them.
+    prologue = [
+        AssignStmt(p.name, p.annotation, NameExpr(p.name), line=stmt.line, column=stmt.column)
+        for p in stmt.params
+        if p.annotation in TYPECODES
+    ]
+    body = prologue + stmt.body if prologue else stmt.body
+    memo = MemoCache() if stmt.memo else None
+    pooled = not stmt.is_async and not _defines(stmt.body)
+    return BoaFunction(stmt.name, [p.name for p in stmt.params], body, env, stmt.is_async, memo, pooled)
+
+
+def _defines(stmts: list) -> bool:
+    """Whether `stmts` contain a `fn` or `cls`, whose closure would be the running call's `Env`."""
+    for stmt in stmts:
+        if isinstance(stmt, (FunctionDef, ClassDef)):
+            return True
+        if isinstance(stmt, (ForStmt, WhileStmt)) and _defines(stmt.body):
+            return True
+        if isinstance(stmt, IfStmt) and (
+            _defines(stmt.body)
+            or any(_defines(body) for _, body in stmt.elif_blocks)
+            or _defines(stmt.else_body or [])
+        ):
+            return True
+    return False
+
+
+def _release(local: Env) -> None:
+    if len(_free_envs) < POOL_SIZE:
+        local.values.clear()
+        _free_envs.append(local)
+
+
+def _bind_call(fn: BoaFunction, args: list[Any], bound_self: Any | None) -> Env:
+    if _free_envs:
+        local = _free_envs.pop()
+        local.parent = fn.closure
+    else:
+        local = Env(fn.closure)
     params = fn.params
     if bound_self is not None:
         if not params:
@@ -175,13 +644,188 @@ def _call_function(fn: BoaFunction, args: list[Any], bound_self: Any | None = No
         raise RuntimeErrorBoa(f"{fn.name} expects {len(params)} args, got {len(args)}")
     for name, value in zip(params, args):
         local.set(name, value)
+    return local
+
+
+def _call_function(fn: BoaFunction, args: list[Any], bound_self: Any | None = None) -> Any:
+    global _depth, _peak_depth
+    memo, key = fn.memo, None
+    if memo is not None:
+        key = memo_key(args)
+        if key is not None:
+            value = memo.get(key)
+            if value is not MISSING:
+                return value
+    local = _bind_call(fn, args, bound_self)
+    if fn.is_async:
+        return BoaCoroutine(fn.name, _run_coroutine(fn, local))
+    if _profiler is not None:
+        _profiler.enter(fn.name)
+        try:
+            completion = _exec_block(fn.body, local)
+        finally:
+            _profiler.exit()
+        if fn.pooled:
+            _release(local)
+        value = None if completion is None else completion.value
+        if key is not None:
+            memo.store(key, value)
+        return value
+    if _depth >= _peak_depth:
+        if _depth >= _max_stack:
+            raise _stack_overflow(_max_stack)
+        _peak_depth = _depth + 1
+        STATS.reached(_peak_depth)
+    _depth += 1
     try:
-        _exec_block(fn.body, local)
-    except _ReturnSignal as rs:
-        return rs.value
+        completion = _exec_block(fn.body, local)
+        # A tail call reuses this activation instead of nesting another one.
+        while type(completion) is _TailCall:
+            if fn.pooled:
+                _release(local)
+            fn = completion.function
+            local = _bind_call(fn, completion.args, completion.receiver)
+            completion = _exec_block(fn.body, local)
+    finally:
+        _depth -= 1
+    if fn.pooled:
+        _release(local)
+    value = None if completion is None else completion.value
+    if key is not None:
+        # A tail call from the body (which rebinds `fn`) is part of its result.
+        memo.store(key, value)
+    return value
+
+
+def _tail_call(call: CallExpr, env: Env) -> _Return | _TailCall:
+    func = call.func
+    if isinstance(func, AttrExpr):
+        target = _eval_expr(func.target, env)
+        callee, method = _member(target, func)
+        args = [_eval_expr(a, env) for a in call.args]
+        if method is not None:
+            return _TailCall(method, args, target)
+    else:
+        callee = _eval_expr(func, env)
+        args = [_eval_expr(a, env) for a in call.args]
+    if isinstance(callee, BoaFunction) and not callee.is_async and callee.memo is None:
+        return _TailCall(callee, args, None)
+    if isinstance(callee, BoundMethod) and not callee.function.is_async:
+        return _TailCall(callee.function, args, callee.receiver)
+    return _Return(_call_value(callee, args))
+
+
+# Coroutines. An `afn` body runs through these generator twins of
+# `_exec_block`/`_exec_stmt`, which suspend at an `aw` (semantic analysis only
+# allows one as the whole value of a simple statement). Statements without
+# one, and every expression, use the ordinary synchronous evaluator.
+
+
+def _run_coroutine(fn: BoaFunction, local: Env) -> Generator[Any, Any, Any]:
+    completion = yield from _exec_block_async(fn.body, local)
+    return None if completion is None else completion.value
+
+
+def _exec_block_async(stmts: list, env: Env) -> Generator[Any, Any, Any]:
+    for stmt in stmts:
+        if _profiler is not None:
+            _profiler.line(stmt.line)
+        try:
+            completion = yield from _exec_stmt_async(stmt, env)
+        except RuntimeErrorBoa as exc:
+            _locate(exc, stmt)
+            raise
+        if completion is not None:
+            return completion
     return None
 
 
+def _exec_loop_async(body: list, env: Env) -> Generator[Any, Any, Any]:
+    """Run one iteration; returns `(stop, completion)` for the enclosing loop."""
+    completion = yield from _exec_block_async(body, env)
+    if completion is None or completion is _CONTINUE:
+        return False, None
+    if completion is _BREAK:
+        return True, None
+    return True, completion
+
+
+def _exec_stmt_async(stmt, env: Env) -> Generator[Any, Any, Any]:
+    if isinstance(stmt, (AssignStmt, ReturnStmt)):
+        expr = stmt.value
+    elif isinstance(stmt, (ExprStmt, OutStmt)):
+        expr = stmt.expr
+    else:
+        expr = None
+    if isinstance(expr, AwaitExpr):
+        value = yield from await_value(_eval_expr(expr.expr, env))
+        if isinstance(stmt, AssignStmt):
+            env.set(stmt.name, pack(value, stmt.annotation) if stmt.annotation in TYPECODES else value)
+        elif isinstance(stmt, OutStmt):
+            STDOUT.line(value)
+        elif isinstance(stmt, ReturnStmt):
+            return _Return(value)
+        return None
+    if isinstance(stmt, IfStmt):
+        for cond, body in [(stmt.condition, stmt.body), *stmt.elif_blocks]:
+            if _truthy(_eval_expr(cond, env)):
+                return (yield from _exec_block_async(body, env))
+        if stmt.else_body is not None:
+            return (yield from _exec_block_async(stmt.else_body, env))
+        return None
+    if isinstance(stmt, ForStmt) and not stmt.parallel:
+        for item in _eval_expr(stmt.iterable, env):
+            env.values[stmt.var_name] = item
+            stop, completion = yield from _exec_loop_async(stmt.body, env)
+            if stop:
+                return completion
+        return None
+    if isinstance(stmt, WhileStmt):
+        while _truthy(_eval_expr(stmt.condition, env)):
+            stop, completion = yield from _exec_loop_async(stmt.body, env)
+            if stop:
+                return completion
+        return None
+    completion = _exec_stmt(stmt, env)
+    if type(completion) is _TailCall:
+        # The coroutine's own frame cannot be replaced; run the call here.
+        return _Return(_call_function(completion.function, completion.args, completion.receiver))
+    return completion
+
+
+def _call_value(callee: Any, args: list[Any]) -> Any:
+    if isinstance(callee, BoaFunction):
+        return _call_function(callee, args)
+    if isinstance(callee, BoundMethod):
+        return _call_function(callee.function, args, bound_self=callee.receiver)
+    if isinstance(callee, BoaClass):
+        inst = BoaInstance(callee)
+        init = callee.methods.get("__init__")
+        if init is not None:
+            _call_function(init, args, bound_self=inst)
+        return inst
+    if callable(callee):
+        return callee(*args)
+    raise RuntimeErrorBoa("Attempted to call non-callable value")
+
+
+def _member(target: Any, expr: AttrExpr) -> tuple[Any, Any]:
+    if type(target) is not BoaInstance:
+        if type(target) is BoaModule:
+            return target.member(expr.name), None
+        raise RuntimeErrorBoa("Attribute access supported only on instances")
+    site = _sites.get(id(expr)) or _site(expr)
+    if target.cls is site[0]:
+        slot = site[1]
+        if slot >= 0:
+            value = target.values[slot]
+            if value is not NO_FIELD:
+                return value, None
+        elif target.extra is None:
+            return None, site[2]
+    return resolve_member(target, expr.name, site)
+
+
 def _eval_binary(op: str, left: Any, right: Any) -> Any:
     if op == "+":
         return left + right
@@ -221,58 +865,63 @@ def _eval_binary(op: str, left: Any, right: Any) -> Any:
 
 
 def _eval_expr(expr: Expr, env: Env) -> Any:
-    if isinstance(expr, NameExpr):
-        return env.get(expr.name)
-    if isinstance(expr, NumberExpr):
-        return expr.value
-    if isinstance(expr, StringExpr):
-        return _eval_fstring(expr.value, env) if expr.is_fstring else expr.value
-    if isinstance(expr, BoolExpr):
-        return expr.value
-    if isinstance(expr, NilExpr):
-        return None
-    if isinstance(expr, ListExpr):
-        return [_eval_expr(e, env) for e in expr.elements]
-    if isinstance(expr, DictExpr):
-        return {_eval_expr(k, env): _eval_expr(v, env) for k, v in expr.entries}
-    if isinstance(expr, UnaryExpr):
-        v = _eval_expr(expr.expr, env)
-        if expr.op == "-":
-            return -v
-        if expr.op == "!":
-            return not _truthy(v)
-        raise RuntimeErrorBoa(f"Unsupported unary operator '{expr.op}'")
-    if isinstance(expr, BinaryExpr):
-        if expr.op == "&&":
-            left = _eval_expr(expr.left, env)
-            return _truthy(left) and _truthy(_eval_expr(expr.right, env))
-        if expr.op == "||":
-            left = _eval_expr(expr.left, env)
-            return _truthy(left) or _truthy(_eval_expr(expr.right, env))
-        return _eval_binary(expr.op, _eval_expr(expr.left, env), _eval_expr(expr.right, env))
-    if isinstance(expr, AttrExpr):
-        target = _eval_expr(expr.target, env)
-        if isinstance(target, BoaInstance):
-            if expr.name in target.fields:
-                return target.fields[expr.name]
-            if expr.name in target.cls.methods:
-                fn = target.cls.methods[expr.name]
-                return lambda *args: _call_function(fn, list(args), bound_self=target)
-            raise RuntimeErrorBoa(f"Unknown member '{expr.name}'")
-        raise RuntimeErrorBoa("Attribute access supported only on instances")
-    if isinstance(expr, CallExpr):
-        callee = _eval_expr(expr.func, env)
-        args = [_eval_expr(a, env) for a in expr.args]
-        if isinstance(callee, BoaFunction):
-            return _call_function(callee, args)
-        if isinstance(callee, BoaClass):
-            inst = BoaInstance(callee, {})
-            init = callee.methods.get("__init__")
-            if init is not None:
-                _call_function(init, args, bound_self=inst)
-            return inst
-        if callable(callee):
-            return callee(*args)
-        raise RuntimeErrorBoa("Attempted to call non-callable value")
-
-    raise RuntimeErrorBoa(f"Unsupported expression {type(expr).__name__}")
+    # The innermost expression an error passes through is where it happened.
+    try:
+        if isinstance(expr, NameExpr):
+            return env.get(expr.name)
+        if isinstance(expr, NumberExpr):
+            return expr.value
+        if isinstance(expr, StringExpr):
+            return expr.value
+        if isinstance(expr, FStringExpr):
+            return "".join(part if isinstance(part, str) else str(_eval_expr(part, env)) for part in expr.parts)
+        if isinstance(expr, BoolExpr):
+            return expr.value
+        if isinstance(expr, NilExpr):
+            return None
+        if isinstance(expr, ListExpr):
+            return [_eval_expr(e, env) for e in expr.elements]
+        if isinstance(expr, DictExpr):
+            return {_eval_expr(k, env): _eval_expr(v, env) for k, v in expr.entries}
+        if isinstance(expr, UnaryExpr):
+            v = _eval_expr(expr.expr, env)
+            if expr.op == "-":
+                return -v
+            if expr.op == "!":
+                return not _truthy(v)
+            raise RuntimeErrorBoa(f"Unsupported unary operator '{expr.op}'")
+        if isinstance(expr, BinaryExpr):
+            if expr.op == "&&":
+                left = _eval_expr(expr.left, env)
+                return _truthy(left) and _truthy(_eval_expr(expr.right, env))
+            if expr.op == "||":
+                left = _eval_expr(expr.left, env)
+                return _truthy(left) or _truthy(_eval_expr(expr.right, env))
+            return _eval_binary(expr.op, _eval_expr(expr.left, env), _eval_expr(expr.right, env))
+        if isinstance(expr, AttrExpr):
+            target = _eval_expr(expr.target, env)
+            value, method = _member(target, expr)
+            return value if method is None else BoundMethod(method, target)
+        if isinstance(expr, CallExpr):
+            func = expr.func
+            if isinstance(func, AttrExpr):
+                # `obj.m(...)` calls the method directly with `obj` bound as the
+                # receiver instead of materializing a bound-method object first.
+                target = _eval_expr(func.target, env)
+                callee, method = _member(target, func)
+                args = [_eval_expr(a, env) for a in expr.args]
+                if method is not None:
+                    return _call_function(method, args, bound_self=target)
+            else:
+                callee = _eval_expr(func, env)
+                args = [_eval_expr(a, env) for a in expr.args]
+            return _call_value(callee, args)
+        if isinstance(expr, SuperCallExpr):
+            method = super_method(env.get(_SUPER), expr.name)
+            args = [_eval_expr(a, env) for a in expr.args]
+            return _call_function(method, args, bound_self=env.get(expr.receiver))
+
+        raise RuntimeErrorBoa(f"Unsupported expression {type(expr).__name__}")
+    except RuntimeErrorBoa as exc:
+        _locate(exc, expr)
+        raise
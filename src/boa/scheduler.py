@@ -0,0 +1,80 @@
+"""Coroutine scheduling for `afn`/`aw`, bridged onto one asyncio event loop.
+
+Both engines represent a call to an `afn` as a `runtime.BoaCoroutine`: a
+generator that runs the function body and yields whenever it awaits something
+native (a sleep, a gather, a timeout). `aw` on another Boa coroutine delegates
+to it directly with `yield from`, so a chain of Boa awaits costs no trip
+through the loop. `drive` is the single bridge: it steps a coroutine and
+awaits each native request on the running loop, which is what lets thousands
+of concurrent waits share one thread.
+
+`use asyncio` binds `module()`, whose members are the scheduling primitives:
+
+* `run(aw)` runs a coroutine to completion on a fresh event loop.
+* `sleep(seconds)` suspends the caller.
+* `gather(a, b, ...)` awaits every argument concurrently; yields a list. A
+  single list argument gathers its elements instead.
+* `timeout(aw, seconds)` yields the result, or nil if it took longer (the
+  awaited work is cancelled).
+* `spawn(aw)` starts a coroutine concurrently; `aw` the returned task later.
+"""
+
+from __future__ import annotations
+
+import asyncio
+from collections.abc import Awaitable
+import inspect
+from typing import Any
+
+from .runtime import BoaCoroutine, BoaModule, RuntimeErrorBoa, await_value
+
+
+async def drive(value: Any) -> Any:
+    """Run a Boa coroutine (or any awaitable) on the running event loop."""
+    if type(value) is not BoaCoroutine:
+        if not inspect.isawaitable(value):
+            raise RuntimeErrorBoa(f"Cannot await a value of type {type(value).__name__}")
+        return await value
+    steps = await_value(value)
+    result = None
+    while True:
+        try:
+            request = steps.send(result)
+        except StopIteration as stop:
+            return stop.value
+        result = await request
+
+
+def _run(value: Any) -> Any:
+    return asyncio.run(drive(value))
+
+
+def _sleep(seconds: float) -> Awaitable[None]:
+    return asyncio.sleep(seconds)
+
+
+async def _gather(*values: Any) -> list[Any]:
+    if len(values) == 1 and type(values[0]) is list:
+        values = tuple(values[0])
+    return list(await asyncio.gather(*(drive(v) for v in values)))
+
+
+async def _timeout(value: Any, seconds: float) -> Any:
+    try:
+        return await asyncio.wait_for(drive(value), seconds)
+    except asyncio.TimeoutError:
+        return None
+
+
+def _spawn(value: Any) -> asyncio.Task[Any]:
+    try:
+        return asyncio.get_running_loop().create_task(drive(value))
+    except RuntimeError:
+        raise RuntimeErrorBoa("spawn() needs a running scheduler; start one with run()") from None
+
+
+def module() -> BoaModule:
+    return BoaModule(
+        "asyncio",
+        {"run": _run, "sleep": _sleep, "gather": _gather, "timeout": _timeout, "spawn": _spawn},
+    )
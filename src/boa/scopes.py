@@ -0,0 +1,149 @@
+"""Static scope resolution for Boa programs.
+
+Every function body gets a fixed table of local slots: parameters first, then
+each name the body binds (assignments, `for` targets, nested `fn`/`cls`). A
+name reference then resolves at compile time to one of:
+
+* a local slot in the current function (`FAST`),
+* a slot in an enclosing function, addressed by depth and slot (`DEREF`),
+* a module-level or builtin name looked up by name (`GLOBAL`).
+
+`if`/`for` bodies do not open scopes of their own, so a loop never allocates
+anything per iteration to hold its variables.
+
+Classes get the same treatment for instance fields: `instance_layout` lists
+the attributes `__init__` assigns on its receiver, and instances store those
+in a fixed slot array.
+"""
+
+from __future__ import annotations
+
+from dataclasses import dataclass, field
+
+from .ast_nodes import (
+    AssignStmt,
+    AttrAssignStmt,
+    ClassDef,
+    ForStmt,
+    FunctionDef,
+    IfStmt,
+    NameExpr,
+    Program,
+    UseStmt,
+    WhileStmt,
+)
+
+FAST = "fast"
+DEREF = "deref"
+GLOBAL = "global"
+
+
+@dataclass
+class FunctionScope:
+    name: str
+    parent: FunctionScope | None
+    slots: dict[str, int] = field(default_factory=dict)
+
+    @property
+    def varnames(self) -> list[str]:
+        return list(self.slots)
+
+    def declare(self, name: str) -> int:
+        slot = self.slots.get(name)
+        if slot is None:
+            slot = len(self.slots)
+            self.slots[name] = slot
+        return slot
+
+    def lookup(self, name: str) -> tuple[str, int, int]:
+        """Return `(kind, depth, slot)` for a reference to `name`."""
+        scope: FunctionScope | None = self
+        depth = 0
+        while scope is not None:
+            slot = scope.slots.get(name)
+            if slot is not None:
+                return (FAST if depth == 0 else DEREF), depth, slot
+            scope = scope.parent
+            depth += 1
+        return GLOBAL, 0, 0
+
+
+def use_bindings(stmt: UseStmt) -> list[str]:
+    """Names a `use` binds: the module itself, or the members listed after `:`."""
+    return [stmt.module] if stmt.names is None else list(stmt.names)
+
+
+def resolve_scopes(program: Program) -> dict[int, FunctionScope]:
+    """Map `id(FunctionDef)` to its resolved scope for every function in `program`."""
+    table: dict[int, FunctionScope] = {}
+
+    def visit_function(fn: FunctionDef, parent: FunctionScope | None) -> None:
+        scope = FunctionScope(fn.name, parent)
+        for param in fn.params:
+            scope.declare(param.name)
+        table[id(fn)] = scope
+        visit_block(fn.body, scope)
+
+    def visit_block(stmts: list, scope: FunctionScope | None) -> None:
+        for stmt in stmts:
+            if isinstance(stmt, FunctionDef):
+                if scope is not None:
+                    scope.declare(stmt.name)
+                visit_function(stmt, scope)
+            elif isinstance(stmt, ClassDef):
+                if scope is not None:
+                    scope.declare(stmt.name)
+                for child in stmt.body:
+                    if isinstance(child, FunctionDef):
+                        visit_function(child, scope)
+            elif isinstance(stmt, AssignStmt):
+                if scope is not None:
+                    scope.declare(stmt.name)
+            elif isinstance(stmt, ForStmt):
+                if scope is not None:
+                    scope.declare(stmt.var_name)
+                visit_block(stmt.body, scope)
+            elif isinstance(stmt, WhileStmt):
+                visit_block(stmt.body, scope)
+            elif isinstance(stmt, UseStmt):
+                if scope is not None:
+                    for name in use_bindings(stmt):
+                        scope.declare(name)
+            elif isinstance(stmt, IfStmt):
+                visit_block(stmt.body, scope)
+                for _, body in stmt.elif_blocks:
+                    visit_block(body, scope)
+                if stmt.else_body is not None:
+                    visit_block(stmt.else_body, scope)
+
+    visit_block(program.statements, None)
+    return table
+
+
+def instance_layout(cls: ClassDef) -> list[str]:
+    """Field names `__init__` assigns on its receiver, in first-assignment order."""
+    init = next(
+        (child for child in cls.body if isinstance(child, FunctionDef) and child.name == "__init__"),
+        None,
+    )
+    if init is None or not init.params:
+        return []
+    receiver = init.params[0].name
+    fields: dict[str, None] = {}
+
+    def visit(stmts: list) -> None:
+        for stmt in stmts:
+            if isinstance(stmt, AttrAssignStmt):
+                if isinstance(stmt.target, NameExpr) and stmt.target.name == receiver:
+                    fields.setdefault(stmt.name)
+            elif isinstance(stmt, (ForStmt, WhileStmt)):
+                visit(stmt.body)
+            elif isinstance(stmt, IfStmt):
+                visit(stmt.body)
+                for _, body in stmt.elif_blocks:
+                    visit(body)
+                if stmt.else_body is not None:
+                    visit(stmt.else_body)
+
+    visit(init.body)
+    return list(fields)
@@ -4,26 +4,45 @@ from __future__ import annotations
 
 from .ast_nodes import (
     AssignStmt,
+    AttrAssignStmt,
+    AttrExpr,
+    AwaitExpr,
+    BinaryExpr,
     BoolExpr,
+    BreakStmt,
+    CallExpr,
     ClassDef,
+    ContinueStmt,
     DictExpr,
+    ExprStmt,
+    ForStmt,
+    FStringExpr,
     FunctionDef,
     IfStmt,
     ListExpr,
     NameExpr,
     NilExpr,
     NumberExpr,
+    OutStmt,
     Program,
     ReturnStmt,
     StringExpr,
+    SuperCallExpr,
+    UnaryExpr,
+    UseStmt,
+    WhileStmt,
 )
+from .scopes import use_bindings
 
 
 BUILTIN_TYPES = {"i", "s", "f", "b", "[i]", "[s]", "[f]", "[b]", "{s:i}", "{s:s}"}
 
 
 class SemanticError(ValueError):
-    pass
+    def __init__(self, message: str, line: int | None = None) -> None:
+        super().__init__(message)
+        # Source line of the innermost statement it was raised for.
+        self.line = line
 
 
 def _is_valid_type_name(name: str) -> bool:
@@ -61,45 +80,308 @@ def _literal_type(expr) -> str | None:
     return None
 
 
+def _has_await(expr) -> bool:
+    if isinstance(expr, AwaitExpr):
+        return True
+    if isinstance(expr, BinaryExpr):
+        return _has_await(expr.left) or _has_await(expr.right)
+    if isinstance(expr, UnaryExpr):
+        return _has_await(expr.expr)
+    if isinstance(expr, CallExpr):
+        return _has_await(expr.func) or any(_has_await(a) for a in expr.args)
+    if isinstance(expr, SuperCallExpr):
+        return any(_has_await(a) for a in expr.args)
+    if isinstance(expr, AttrExpr):
+        return _has_await(expr.target)
+    if isinstance(expr, ListExpr):
+        return any(_has_await(e) for e in expr.elements)
+    if isinstance(expr, DictExpr):
+        return any(_has_await(k) or _has_await(v) for k, v in expr.entries)
+    if isinstance(expr, FStringExpr):
+        return any(not isinstance(p, str) and _has_await(p) for p in expr.parts)
+    return False
+
+
+def _has_stray_super(expr) -> bool:
+    """Whether `expr` has a `super()` call outside a method of a class with a base."""
+    if isinstance(expr, SuperCallExpr):
+        return expr.receiver is None or any(_has_stray_super(a) for a in expr.args)
+    if isinstance(expr, BinaryExpr):
+        return _has_stray_super(expr.left) or _has_stray_super(expr.right)
+    if isinstance(expr, (UnaryExpr, AwaitExpr)):
+        return _has_stray_super(expr.expr)
+    if isinstance(expr, CallExpr):
+        return _has_stray_super(expr.func) or any(_has_stray_super(a) for a in expr.args)
+    if isinstance(expr, AttrExpr):
+        return _has_stray_super(expr.target)
+    if isinstance(expr, ListExpr):
+        return any(_has_stray_super(e) for e in expr.elements)
+    if isinstance(expr, DictExpr):
+        return any(_has_stray_super(k) or _has_stray_super(v) for k, v in expr.entries)
+    if isinstance(expr, FStringExpr):
+        return any(not isinstance(p, str) and _has_stray_super(p) for p in expr.parts)
+    return False
+
+
+def _stmt_exprs(stmt) -> list[tuple[object, bool]]:
+    """The expressions of `stmt`, each with whether it may be an `aw` itself."""
+    if isinstance(stmt, AssignStmt):
+        return [(stmt.value, True)]
+    if isinstance(stmt, (ExprStmt, OutStmt)):
+        return [(stmt.expr, True)]
+    if isinstance(stmt, ReturnStmt):
+        return [] if stmt.value is None else [(stmt.value, True)]
+    if isinstance(stmt, AttrAssignStmt):
+        return [(stmt.target, False), (stmt.value, False)]
+    if isinstance(stmt, IfStmt):
+        return [(stmt.condition, False), *((cond, False) for cond, _ in stmt.elif_blocks)]
+    if isinstance(stmt, ForStmt):
+        return [(stmt.iterable, False)]
+    if isinstance(stmt, WhileStmt):
+        return [(stmt.condition, False)]
+    return []
+
+
+def _check_awaits(stmt, in_async: bool) -> None:
+    # Coroutines suspend only at statement boundaries: `aw` must be the whole
+    # value of an assignment, `ret`, `out` or expression statement.
+    for expr, may_await in _stmt_exprs(stmt):
+        if may_await and isinstance(expr, AwaitExpr):
+            if not in_async:
+                raise SemanticError("'aw' used outside afn")
+            expr = expr.expr
+        if _has_await(expr):
+            if not in_async:
+                raise SemanticError("'aw' used outside afn")
+            raise SemanticError("'aw' must be the whole value of an assignment, 'ret', 'out' or expression")
+
+
+def _expr_names(expr, names: set[str]) -> None:
+    if isinstance(expr, NameExpr):
+        names.add(expr.name)
+    elif isinstance(expr, BinaryExpr):
+        _expr_names(expr.left, names)
+        _expr_names(expr.right, names)
+    elif isinstance(expr, (UnaryExpr, AwaitExpr)):
+        _expr_names(expr.expr, names)
+    elif isinstance(expr, CallExpr):
+        _expr_names(expr.func, names)
+        for arg in expr.args:
+            _expr_names(arg, names)
+    elif isinstance(expr, SuperCallExpr):
+        if expr.receiver is not None:
+            names.add(expr.receiver)
+        for arg in expr.args:
+            _expr_names(arg, names)
+    elif isinstance(expr, AttrExpr):
+        _expr_names(expr.target, names)
+    elif isinstance(expr, ListExpr):
+        for element in expr.elements:
+            _expr_names(element, names)
+    elif isinstance(expr, DictExpr):
+        for key, value in expr.entries:
+            _expr_names(key, names)
+            _expr_names(value, names)
+    elif isinstance(expr, FStringExpr):
+        for part in expr.parts:
+            if not isinstance(part, str):
+                _expr_names(part, names)
+
+
+def _bound(stmt) -> list[str]:
+    if isinstance(stmt, (AssignStmt, FunctionDef, ClassDef)):
+        return [stmt.name]
+    if isinstance(stmt, ForStmt):
+        return [stmt.var_name]
+    if isinstance(stmt, UseStmt):
+        return use_bindings(stmt)
+    return []
+
+
+def _child_blocks(stmt) -> list[list]:
+    if isinstance(stmt, (ForStmt, WhileStmt)):
+        return [stmt.body]
+    if isinstance(stmt, IfStmt):
+        return [stmt.body, *(body for _, body in stmt.elif_blocks), stmt.else_body or []]
+    return []
+
+
+def _check_memo(stmts: list, name: str) -> None:
+    """Reject effects in the body of `memo fn name` that a cached call would skip."""
+    for stmt in stmts:
+        effect = None
+        if isinstance(stmt, OutStmt):
+            effect = "'out'"
+        elif isinstance(stmt, AttrAssignStmt):
+            effect = "an attribute assignment"
+        else:
+            names: set[str] = set()
+            for expr, _ in _stmt_exprs(stmt):
+                _expr_names(expr, names)
+            if "ask" in names:
+                effect = "'ask'"
+        if effect is not None:
+            raise SemanticError(f"memo fn '{name}' cannot use {effect}; cached calls skip it", stmt.line)
+        if isinstance(stmt, (FunctionDef, ClassDef)):
+            _check_memo(stmt.body, name)
+        for body in _child_blocks(stmt):
+            _check_memo(body, name)
+
+
+def _scope_names(stmts: list, names: set[str], pfors: list[ForStmt]) -> None:
+    """Add the names `stmts` bind or read outside any `pfor` body; collect the outermost `pfor`s.
+
+    Nested function and class bodies are scopes of their own, so only their
+    names count.
+    """
+    for stmt in stmts:
+        for expr, _ in _stmt_exprs(stmt):
+            _expr_names(expr, names)
+        if isinstance(stmt, ForStmt) and stmt.parallel:
+            pfors.append(stmt)
+            continue
+        names.update(_bound(stmt))
+        for body in _child_blocks(stmt):
+            _scope_names(body, names, pfors)
+
+
+def _assigned(stmts: list, names: set[str]) -> None:
+    for stmt in stmts:
+        names.update(_bound(stmt))
+        for body in _child_blocks(stmt):
+            _assigned(body, names)
+
+
+def _check_pfor_scope(stmts: list, params: list[str]) -> None:
+    """Reject a `pfor` body that assigns a name the rest of its scope binds or reads.
+
+    Each iteration runs in a worker process, so whatever it assigns is lost
+    once it finishes; only what nothing outside the loop touches is safe.
+    """
+    outside = set(params)
+    pfors: list[ForStmt] = []
+    _scope_names(stmts, outside, pfors)
+    for stmt in pfors:
+        private = {stmt.var_name}
+        _assigned(stmt.body, private)
+        shared = private & outside
+        if shared:
+            name = min(shared)
+            raise SemanticError(
+                f"'pfor' body assigns '{name}', which its scope also uses; "
+                "iterations run in separate workers, so collect results with par()",
+                stmt.line,
+            )
+        _check_pfor_scope(stmt.body, [])
+
+
 def analyze(program: Program) -> None:
     symbols: set[str] = set()
+    for stmt in program.statements:
+        for name in check_statement(stmt):
+            if name in symbols:
+                raise SemanticError(f"Duplicate symbol '{name}'", stmt.line)
+            symbols.add(name)
+    # Module-level loops depend on the whole program; function bodies were
+    # checked with their `FunctionDef`.
+    _check_pfor_scope(program.statements, [])
+
 
-    def walk(stmts, fn_depth: int = 0) -> None:
+def check_statement(stmt) -> list[str]:
+    """Validate one top-level statement on its own.
+
+    Returns the function and class names it declares at module level, in
+    order, for the caller's program-wide duplicate check (see `analyze`);
+    checking one statement never depends on the others, which is what lets an
+    editor re-check only the declarations that changed (see `document`).
+    """
+    symbols: list[str] = []
+
+    # `declared` collects the function and class names of the scope `stmts`
+    # belong to, `loop_depth` counts loops enclosing `stmts` within the
+    # current function, `in_async` is whether that function is an `afn`, and
+    # `pfor_depth` is the `loop_depth` of the innermost enclosing `pfor` body
+    # (0 outside one).
+    def walk(
+        stmts,
+        declared: list[str],
+        fn_depth: int = 0,
+        loop_depth: int = 0,
+        in_async: bool = False,
+        pfor_depth: int = 0,
+    ) -> None:
         for stmt in stmts:
-            if isinstance(stmt, FunctionDef):
-                if stmt.name in symbols:
-                    raise SemanticError(f"Duplicate symbol '{stmt.name}'")
-                symbols.add(stmt.name)
-                for p in stmt.params:
-                    if p.annotation and not _is_valid_type_name(p.annotation):
-                        raise SemanticError(f"Invalid parameter type '{p.annotation}'")
-                if stmt.return_annotation and not _is_valid_type_name(stmt.return_annotation):
-                    raise SemanticError(f"Invalid return type '{stmt.return_annotation}'")
-                walk(stmt.body, fn_depth + 1)
-            elif isinstance(stmt, ClassDef):
-                if stmt.name in symbols:
-                    raise SemanticError(f"Duplicate symbol '{stmt.name}'")
-                symbols.add(stmt.name)
-                walk(stmt.body, fn_depth)
-            elif isinstance(stmt, ReturnStmt):
-                if fn_depth == 0:
-                    raise SemanticError("'ret' used outside function")
-            elif isinstance(stmt, AssignStmt):
-                if stmt.annotation and not _is_valid_type_name(stmt.annotation):
-                    raise SemanticError(f"Invalid annotation '{stmt.annotation}'")
-                if stmt.annotation:
-                    lt = _literal_type(stmt.value)
-                    if lt == "nil":
-                        continue
-                    if lt in {"i", "s", "f", "b"} and stmt.annotation not in {lt, f"{lt}?"}:
-                        raise SemanticError(
-                            f"Type mismatch for '{stmt.name}': expected {stmt.annotation}, got {lt}"
-                        )
-            elif isinstance(stmt, IfStmt):
-                walk(stmt.body, fn_depth)
-                for _, body in stmt.elif_blocks:
-                    walk(body, fn_depth)
-                if stmt.else_body is not None:
-                    walk(stmt.else_body, fn_depth)
-
-    walk(program.statements)
+            try:
+                check(stmt, declared, fn_depth, loop_depth, in_async, pfor_depth)
+            except SemanticError as exc:
+                if exc.line is None:
+                    exc.line = stmt.line
+                raise
+
+    def check(stmt, declared: list[str], fn_depth: int, loop_depth: int, in_async: bool, pfor_depth: int) -> None:
+        if pfor_depth:
+            if isinstance(stmt, ReturnStmt):
+                raise SemanticError("'ret' cannot leave a pfor body")
+            if isinstance(stmt, BreakStmt) and loop_depth == pfor_depth:
+                raise SemanticError("'break' cannot leave a pfor body")
+            if isinstance(stmt, AttrAssignStmt):
+                raise SemanticError("'pfor' body cannot assign attributes; workers do not share objects")
+            if any(_has_await(expr) for expr, _ in _stmt_exprs(stmt)):
+                raise SemanticError("'aw' cannot be used in a pfor body")
+        _check_awaits(stmt, in_async)
+        if any(_has_stray_super(expr) for expr, _ in _stmt_exprs(stmt)):
+            raise SemanticError("'super()' used outside a method of a class with a base")
+        if isinstance(stmt, FunctionDef):
+            if stmt.name in declared:
+                raise SemanticError(f"Duplicate symbol '{stmt.name}'")
+            declared.append(stmt.name)
+            for p in stmt.params:
+                if p.annotation and not _is_valid_type_name(p.annotation):
+                    raise SemanticError(f"Invalid parameter type '{p.annotation}'")
+            if stmt.return_annotation and not _is_valid_type_name(stmt.return_annotation):
+                raise SemanticError(f"Invalid return type '{stmt.return_annotation}'")
+            if stmt.memo:
+                _check_memo(stmt.body, stmt.name)
+            walk(stmt.body, [], fn_depth + 1, 0, stmt.is_async)
+            _check_pfor_scope(stmt.body, [p.name for p in stmt.params])
+        elif isinstance(stmt, ClassDef):
+            if stmt.name in declared:
+                raise SemanticError(f"Duplicate symbol '{stmt.name}'")
+            declared.append(stmt.name)
+            for child in stmt.body:
+                if isinstance(child, FunctionDef) and child.name == "__init__" and child.is_async:
+                    raise SemanticError(f"'{stmt.name}.__init__' cannot be an afn")
+                if isinstance(child, FunctionDef) and child.memo:
+                    raise SemanticError(f"Method '{stmt.name}.{child.name}' cannot be a memo fn", child.line)
+            walk(stmt.body, [], fn_depth)
+        elif isinstance(stmt, ReturnStmt):
+            if fn_depth == 0:
+                raise SemanticError("'ret' used outside function")
+        elif isinstance(stmt, (BreakStmt, ContinueStmt)):
+            if loop_depth == 0:
+                keyword = "break" if isinstance(stmt, BreakStmt) else "continue"
+                raise SemanticError(f"'{keyword}' used outside loop")
+        elif isinstance(stmt, ForStmt) and stmt.parallel:
+            walk(stmt.body, declared, fn_depth, loop_depth + 1, in_async, loop_depth + 1)
+        elif isinstance(stmt, (ForStmt, WhileStmt)):
+            walk(stmt.body, declared, fn_depth, loop_depth + 1, in_async, pfor_depth)
+        elif isinstance(stmt, AssignStmt):
+            if stmt.annotation and not _is_valid_type_name(stmt.annotation):
+                raise SemanticError(f"Invalid annotation '{stmt.annotation}'")
+            if stmt.annotation:
+                lt = _literal_type(stmt.value)
+                if lt == "nil":
+                    return
+                if lt in {"i", "s", "f", "b"} and stmt.annotation not in {lt, f"{lt}?"}:
+                    raise SemanticError(
+                        f"Type mismatch for '{stmt.name}': expected {stmt.annotation}, got {lt}"
+                    )
+        elif isinstance(stmt, IfStmt):
+            walk(stmt.body, declared, fn_depth, loop_depth, in_async, pfor_depth)
+            for _, body in stmt.elif_blocks:
+                walk(body, declared, fn_depth, loop_depth, in_async, pfor_depth)
+            if stmt.else_body is not None:
+                walk(stmt.else_body, declared, fn_depth, loop_depth, in_async, pfor_depth)
+
+    walk([stmt], symbols)
+    return symbols
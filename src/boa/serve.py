@@ -0,0 +1,218 @@
+"""`boa serve`: a warm process that runs `boa run` commands for other processes.
+
+Starting `boa` costs far more than running a short script: the interpreter
+has to start (and a one-file binary has to unpack itself) and the compiler has
+to be imported. `boa serve` pays for that once. It imports the whole pipeline
+and listens on a Unix domain socket (`--socket`, default `boa.sock` in
+`$XDG_RUNTIME_DIR`, else a per-user name in the temp directory). When
+`$BOA_SERVER` names that socket, `boa run ...` does not run the program
+itself. Instead it sends the socket its arguments, its working directory, its
+environment and its stdin, stdout and stderr descriptors, and waits for the
+exit status.
+
+For each request the server forks a child. The child takes over those
+descriptors, runs the command exactly as `boa run` would, and replies with
+the status, so output goes straight to the caller's terminal or pipe and
+`ask` reads the caller's stdin. Every run gets a fresh fork of the warm
+process, so nothing one program does can leak into the next. If the server
+is unreachable, `boa run` simply runs the program in its own process. Ctrl-C
+in the caller is passed on to the child running its program, and a caller
+that goes away without one (killed, say) interrupts it too.
+
+The socket is created with owner-only permissions. Servers need `fork` and
+Unix sockets, so they are unavailable on Windows.
+"""
+
+from __future__ import annotations
+
+import json
+import os
+import signal
+import socket
+import sys
+import tempfile
+import threading
+import traceback
+
+# Exit status of a run interrupted with Ctrl-C, as a shell reports it.
+_INTERRUPTED = 128 + signal.SIGINT
+
+
+def available() -> bool:
+    return hasattr(socket, "AF_UNIX") and hasattr(socket, "send_fds") and hasattr(os, "fork")
+
+
+def default_socket() -> str:
+    runtime_dir = os.environ.get("XDG_RUNTIME_DIR")
+    if runtime_dir:
+        return os.path.join(runtime_dir, "boa.sock")
+    return os.path.join(tempfile.gettempdir(), f"boa-{os.getuid()}.sock")
+
+
+def _connect(path: str) -> socket.socket | None:
+    sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    try:
+        sock.connect(path)
+    except OSError:
+        sock.close()
+        return None
+    return sock
+
+
+def forward(path: str, argv: list[str]) -> int | None:
+    """Run `boa <argv>` on the server at `path`; None when no server answers there."""
+    if not available():
+        return None
+    sock = _connect(path)
+    if sock is None:
+        return None
+    with sock:
+        request = json.dumps({"argv": argv, "cwd": os.getcwd(), "env": dict(os.environ)}).encode("utf-8")
+        try:
+            socket.send_fds(sock, [len(request).to_bytes(8, "big")], [0, 1, 2])
+            sock.sendall(request)
+            reply = sock.makefile("rb")
+            pid = int(reply.readline() or 0)
+        except (OSError, ValueError):
+            return None
+        if not pid:
+            return None
+        while True:
+            try:
+                status = reply.readline()
+                break
+            except KeyboardInterrupt:
+                os.kill(pid, signal.SIGINT)
+    if not status:
+        print(f"boa: the server at {path} stopped before the program finished", file=sys.stderr)
+        return 1
+    return int(status)
+
+
+def _receive(conn: socket.socket) -> tuple[dict, list[int]] | None:
+    header, fds, _flags, _address = socket.recv_fds(conn, 8, 3)
+    if not header:
+        # A connection closed without a request: someone checking the server is up.
+        return None
+    size = int.from_bytes(header, "big")
+    data = bytearray()
+    while len(data) < size:
+        chunk = conn.recv(size - len(data))
+        if not chunk:
+            raise ConnectionError("request truncated")
+        data += chunk
+    return json.loads(data), fds
+
+
+def _adopt(request: dict, fds: list[int]) -> None:
+    """Make this process look like the caller's: its descriptors, directory and environment."""
+    for target, fd in enumerate(fds):
+        os.dup2(fd, target)
+        os.close(fd)
+    os.chdir(request["cwd"])
+    os.environ.clear()
+    os.environ.update(request["env"])
+    # The child runs the program itself rather than forwarding it again.
+    os.environ.pop("BOA_SERVER", None)
+    sys.stdin = open(0, closefd=False)
+    sys.stdout = open(1, "w", buffering=1 if os.isatty(1) else -1, closefd=False)
+    sys.stderr = open(2, "w", buffering=1, closefd=False)
+
+
+def _watch_caller(conn: socket.socket) -> None:
+    """Interrupt the run once its caller hangs up without passing on a Ctrl-C (say, it was killed)."""
+    try:
+        conn.recv(1)
+    except OSError:
+        pass
+    os.kill(os.getpid(), signal.SIGINT)
+
+
+def _handle(conn: socket.socket) -> int:
+    from .cli import main
+
+    received = _receive(conn)
+    if received is None:
+        return 0
+    request, fds = received
+    _adopt(request, fds)
+    conn.sendall(f"{os.getpid()}\n".encode())
+    threading.Thread(target=_watch_caller, args=(conn,), daemon=True).start()
+    try:
+        status = main(request["argv"])
+    except SystemExit as exc:
+        status = exc.code if isinstance(exc.code, int) else (0 if exc.code is None else 1)
+    except KeyboardInterrupt:
+        status = _INTERRUPTED
+    except BaseException:
+        traceback.print_exc()
+        status = 1
+    # The program is done; a hang-up after this must not interrupt the reply.
+    signal.signal(signal.SIGINT, signal.SIG_IGN)
+    try:
+        sys.stdout.flush()
+        sys.stderr.flush()
+        conn.sendall(f"{status}\n".encode())
+    except OSError:
+        # The caller is gone.
+        pass
+    return status
+
+
+def _warm_up() -> None:
+    # Everything a run can need, so no child imports anything.
+    from . import compiler, files, native, parallel, vectors  # noqa: F401
+
+
+def _terminate(signum: int, frame: object) -> None:
+    raise SystemExit(0)
+
+
+def serve(path: str | None = None) -> int:
+    if not available():
+        print("boa serve needs Unix domain sockets and fork(), which this platform lacks", file=sys.stderr)
+        return 1
+    path = path or default_socket()
+    live = _connect(path)
+    if live is not None:
+        live.close()
+        print(f"A server is already listening on {path}", file=sys.stderr)
+        return 1
+    if os.path.exists(path):
+        # Left behind by a server that did not shut down cleanly.
+        os.unlink(path)
+    _warm_up()
+    server = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    umask = os.umask(0o177)
+    try:
+        server.bind(path)
+    finally:
+        os.umask(umask)
+    server.listen(64)
+    # Finished children are reaped automatically.
+    signal.signal(signal.SIGCHLD, signal.SIG_IGN)
+    signal.signal(signal.SIGTERM, _terminate)
+    print(f"Serving on {path}; set BOA_SERVER={path} to run programs here", file=sys.stderr)
+    sys.stderr.flush()
+    try:
+        while True:
+            conn, _address = server.accept()
+            if os.fork() == 0:
+                status = 1
+                try:
+                    server.close()
+                    signal.signal(signal.SIGCHLD, signal.SIG_DFL)
+                    signal.signal(signal.SIGTERM, signal.SIG_DFL)
+                    # Even if the server was started with Ctrl-C ignored.
+                    signal.signal(signal.SIGINT, signal.default_int_handler)
+                    status = _handle(conn)
+                except BaseException:
+                    traceback.print_exc()
+                finally:
+                    os._exit(status)
+            conn.close()
+    except KeyboardInterrupt:
+        return 0
+    finally:
+        server.close()
+        os.unlink(path)
@@ -0,0 +1,149 @@
+"""Bulk list builtins: `sum`, `min`, `max`, `dot`, `map` and `filter`.
+
+Each runs as one pass of C-level iteration (`array`, `operator`, `itertools`)
+over its operands instead of one interpreted statement per element, and over
+a packed `[i]`/`[f]` array (see `arrays`) it reads the buffer directly and
+builds a packed result. Boa has no lambdas, so `map` and `filter` take the
+operator as a string:
+
+    map(xs, "*", 2)        # every element times 2
+    map(xs, "+", ys)       # element-wise sum of two lists of the same length
+    filter(xs, ">=", 10)   # the elements x for which `x >= 10`
+
+Every result equals what the corresponding `for` loop would compute. An
+operation on a plain list returns a plain list; one on a packed array returns
+a packed array whenever every element of the result has the array's exact
+type, and a plain list otherwise (an int64 overflow, say).
+"""
+
+from __future__ import annotations
+
+from array import array
+from itertools import compress, repeat
+import operator
+from typing import Any, Callable, Iterator
+
+from .arrays import TypedArray
+from .runtime import RuntimeErrorBoa
+
+_ARITHMETIC = {
+    "+": operator.add,
+    "-": operator.sub,
+    "*": operator.mul,
+    "/": operator.truediv,
+    "%": operator.mod,
+}
+_COMPARISONS = {
+    "==": operator.eq,
+    "!=": operator.ne,
+    "<": operator.lt,
+    ">": operator.gt,
+    "<=": operator.le,
+    ">=": operator.ge,
+}
+
+
+def _elements(value: Any) -> Any:
+    return value.data if type(value) is TypedArray else value
+
+
+def _is_list(value: Any) -> bool:
+    return type(value) is list or type(value) is TypedArray
+
+
+def _typecode(value: Any) -> str | None:
+    """The packed element typecode `value` contributes to a result, if it is known."""
+    if type(value) is TypedArray:
+        return value.data.typecode
+    if type(value) is int or type(value) is bool:
+        return "q"
+    if type(value) is float:
+        return "d"
+    return None
+
+
+def _pairs(name: str, xs: Any, operand: Any) -> Callable[[Callable[..., Any]], Iterator[Any]]:
+    """A function mapping a binary operator over `xs` and `operand`, broadcast if a scalar."""
+    if not _is_list(xs):
+        raise RuntimeErrorBoa(f"{name}() expects a list, got {type(xs).__name__}")
+    left = _elements(xs)
+    if _is_list(operand):
+        right = _elements(operand)
+        if len(right) != len(left):
+            raise RuntimeErrorBoa(f"{name}() lists have different lengths ({len(left)} and {len(right)})")
+        return lambda func: map(func, left, right)
+    return lambda func: map(func, left, repeat(operand))
+
+
+def _operator(name: str, table: dict[str, Callable[..., Any]], op: Any) -> Callable[..., Any]:
+    func = table.get(op) if type(op) is str else None
+    if func is None:
+        raise RuntimeErrorBoa(f"{name}() operator must be one of {' '.join(table)}, not {op!r}")
+    return func
+
+
+def _sum(xs: Any) -> Any:
+    if not _is_list(xs) and type(xs) is not range:
+        raise RuntimeErrorBoa(f"sum() expects a list, got {type(xs).__name__}")
+    return sum(_elements(xs))
+
+
+def _extreme(name: str, pick: Callable[..., Any], args: tuple[Any, ...]) -> Any:
+    if not args:
+        raise RuntimeErrorBoa(f"{name}() expects at least one argument")
+    if len(args) > 1:
+        return pick(args)
+    values = args[0]
+    if not _is_list(values) and type(values) is not range:
+        raise RuntimeErrorBoa(f"{name}() of a single value expects a list, got {type(values).__name__}")
+    if not len(values):
+        raise RuntimeErrorBoa(f"{name}() of an empty list")
+    return pick(_elements(values))
+
+
+def _min(*args: Any) -> Any:
+    return _extreme("min", min, args)
+
+
+def _max(*args: Any) -> Any:
+    return _extreme("max", max, args)
+
+
+def _dot(xs: Any, ys: Any) -> Any:
+    if not _is_list(ys):
+        raise RuntimeErrorBoa(f"dot() expects two lists, got {type(ys).__name__}")
+    return sum(_pairs("dot", xs, ys)(operator.mul))
+
+
+def _map(xs: Any, op: Any, operand: Any) -> Any:
+    func = _operator("map", _ARITHMETIC, op)
+    results = _pairs("map", xs, operand)
+    if type(xs) is TypedArray:
+        typecode = _typecode(operand)
+        if typecode is not None:
+            if op == "/" or "d" in (typecode, xs.data.typecode):
+                typecode = "d"
+            try:
+                return TypedArray(array(typecode, results(func)))
+            except OverflowError:
+                # An element outside int64: compute it as a list instead.
+                pass
+    return list(results(func))
+
+
+def _filter(xs: Any, op: Any, operand: Any) -> Any:
+    func = _operator("filter", _COMPARISONS, op)
+    kept = compress(_elements(xs), _pairs("filter", xs, operand)(func))
+    if type(xs) is TypedArray:
+        return TypedArray(array(xs.data.typecode, kept))
+    return list(kept)
+
+
+BUILTINS = {
+    "sum": _sum,
+    "min": _min,
+    "max": _max,
+    "dot": _dot,
+    "map": _map,
+    "filter": _filter,
+}
@@ -0,0 +1,702 @@
+"""Stack-based virtual machine executing Boa bytecode."""
+
+from __future__ import annotations
+
+from collections.abc import Generator
+from typing import Any
+
+from .arrays import PACKED_TYPES, pack
+from .bytecode import (
+    AWAIT,
+    BINARY_FUNCS,
+    BINARY_OP,
+    BUILD_DICT,
+    BUILD_LIST,
+    BUILD_STRING,
+    CALL,
+    CALL_METHOD,
+    COMPARE_JUMP,
+    COMPARE_JUMP_MASK,
+    COMPARE_JUMP_SHIFT,
+    FOR_ITER,
+    FOR_RANGE,
+    FOR_RANGE_MASK,
+    FOR_RANGE_SHIFT,
+    FORMAT_VALUE,
+    GET_ITER,
+    JUMP,
+    LOAD_ATTR,
+    LOAD_CONST,
+    LOAD_DEREF,
+    LOAD_FAST,
+    LOAD_GLOBAL,
+    LOAD_METHOD,
+    LOAD_SUPER,
+    MAKE_CLASS,
+    MAKE_FUNCTION,
+    MEMO_STORE,
+    OUT,
+    PACK,
+    PAR_END,
+    PFOR,
+    POP_JUMP_IF_FALSE,
+    POP_TOP,
+    PROFILE_ENTER,
+    PROFILE_EXIT,
+    PROFILE_LINE,
+    RETURN_VALUE,
+    STORE_ATTR,
+    STORE_FAST,
+    STORE_GLOBAL,
+    TAIL_CALL,
+    TO_BOOL,
+    UNARY_NEG,
+    UNARY_NOT,
+    USE_MODULE,
+    ClassCode,
+    CodeObject,
+)
+from .memo import MISSING, MemoCache, memo_key
+from .memstats import POOL_SIZE, STATS
+from .output import DEFAULT_OUT_BUFFER, STDOUT
+from .parallel import run_chunks
+from .runtime import (
+    DEFAULT_MAX_STACK,
+    NO_FIELD,
+    BoaClass,
+    BoaCoroutine,
+    BoaInstance,
+    BoaModule,
+    BoundMethod,
+    Env,
+    RuntimeErrorBoa,
+    await_value,
+    class_base,
+    import_module,
+    install_builtins,
+    make_class,
+    resolve_member,
+    store_member,
+    super_method,
+)
+
+
+class _Unbound:
+    __slots__ = ()
+
+    def __repr__(self) -> str:
+        return "<unbound>"
+
+
+# Marks a local slot that has not been assigned yet.
+UNBOUND = _Unbound()
+
+
+class VMFunction:
+    __slots__ = ("code", "closure", "globals")
+
+    def __init__(self, code: CodeObject, closure: tuple[list[Any], ...], globals_: dict[str, Any]) -> None:
+        self.code = code
+        # Slot arrays of the enclosing function frames, innermost first.
+        self.closure = closure
+        # Variables of the defining module, which a function imported from
+        # another module still reads when the importer calls it.
+        self.globals = globals_
+
+    @property
+    def name(self) -> str:
+        return self.code.name
+
+    def __repr__(self) -> str:
+        return f"<fn {self.code.name}>"
+
+
+class VMAsyncFunction(VMFunction):
+    """An `afn`: a call binds the frame and returns it wrapped as a coroutine."""
+
+    __slots__ = ("vm",)
+
+    def __init__(self, code: CodeObject, closure: tuple[list[Any], ...], globals_: dict[str, Any], vm: VM) -> None:
+        super().__init__(code, closure, globals_)
+        self.vm = vm
+
+    def start(self, fast: list[Any]) -> BoaCoroutine:
+        frame = Frame(self.code, fast, self.closure, self.globals)
+        return BoaCoroutine(self.code.name, self.vm._coroutine(frame))
+
+    def __repr__(self) -> str:
+        return f"<afn {self.code.name}>"
+
+
+class VMMemoFunction(VMFunction):
+    """A `memo fn`: a call with cached arguments returns without a frame."""
+
+    __slots__ = ("memo",)
+
+    def __init__(self, code: CodeObject, closure: tuple[list[Any], ...], globals_: dict[str, Any]) -> None:
+        super().__init__(code, closure, globals_)
+        self.memo = MemoCache()
+
+    def __repr__(self) -> str:
+        return f"<memo fn {self.code.name}>"
+
+
+class _Suspend:
+    """Returned by `VM._execute` when a coroutine frame reaches AWAIT."""
+
+    __slots__ = ("awaitable",)
+
+    def __init__(self, awaitable: Any) -> None:
+        self.awaitable = awaitable
+
+
+class Frame:
+    __slots__ = ("code", "pc", "stack", "fast", "closure", "globals", "init_instance")
+
+    def __init__(
+        self,
+        code: CodeObject,
+        fast: list[Any],
+        closure: tuple[list[Any], ...],
+        globals_: dict[str, Any],
+        init_instance: BoaInstance | None = None,
+    ) -> None:
+        self.code = code
+        self.pc = 0
+        self.stack: list[Any] = []
+        self.fast = fast
+        self.closure = closure
+        self.globals = globals_
+        self.init_instance = init_instance
+        STATS.frames += 1
+
+
+# Frames of finished calls, reused by the next calls (see `memstats`). Only
+# `_execute` releases frames, and only ones no coroutine or caller still holds.
+_free_frames: list[Frame] = []
+
+
+def _frame(
+    code: CodeObject,
+    fast: list[Any],
+    closure: tuple[list[Any], ...],
+    globals_: dict[str, Any],
+    init_instance: BoaInstance | None = None,
+) -> Frame:
+    if not _free_frames:
+        return Frame(code, fast, closure, globals_, init_instance)
+    frame = _free_frames.pop()
+    frame.pc = 0
+    frame.code = code
+    frame.fast = fast
+    frame.closure = closure
+    frame.globals = globals_
+    frame.init_instance = init_instance
+    return frame
+
+
+def _release(frame: Frame) -> None:
+    if len(_free_frames) < POOL_SIZE:
+        frame.stack.clear()
+        frame.init_instance = None
+        _free_frames.append(frame)
+
+
+def _bind_args(fn: VMFunction, args: list[Any], receiver: Any = None) -> list[Any]:
+    code = fn.code
+    nparams = len(code.params)
+    if receiver is not None:
+        if not nparams:
+            raise RuntimeErrorBoa("Method missing self parameter")
+        args = [receiver, *args]
+    if len(args) != nparams:
+        expected = nparams - (receiver is not None)
+        got = len(args) - (receiver is not None)
+        raise RuntimeErrorBoa(f"{code.name} expects {expected} args, got {got}")
+    extra = len(code.varnames) - nparams
+    return args + [UNBOUND] * extra if extra else args
+
+
+def _enter(fn: VMFunction, args: list[Any], receiver: Any = None, init_instance: Any = None) -> Frame:
+    return _frame(fn.code, _bind_args(fn, args, receiver), fn.closure, fn.globals, init_instance)
+
+
+def _unbound_local(name: str, globals_: dict[str, Any]) -> Any:
+    # A local read before its first assignment falls back to the module
+    # scope, mirroring how the tree-walker's Env chain resolves it.
+    if name in globals_:
+        return globals_[name]
+    raise RuntimeErrorBoa(f"Unknown symbol '{name}'")
+
+
+def _site(code: CodeObject, pc: int) -> list[Any]:
+    site = code.sites.get(pc)
+    if site is None:
+        site = code.sites[pc] = [None, -1, None]
+    return site
+
+
+def _member(target: Any, name: str, site: list[Any]) -> tuple[Any, Any]:
+    # Slow path of LOAD_ATTR/LOAD_METHOD, taken when the site's cached class
+    # does not match; the inline fast paths live in `VM._execute`.
+    if type(target) is not BoaInstance:
+        if type(target) is BoaModule:
+            return target.member(name), None
+        raise RuntimeErrorBoa("Attribute access supported only on instances")
+    return resolve_member(target, name, site)
+
+
+def _frame_for(callee: Any, args: list[Any]) -> tuple[Frame | None, Any]:
+    """Return the frame a call to `callee` must run, or `(None, result)` when it completed natively."""
+    kind = type(callee)
+    if kind is VMFunction:
+        return _frame(callee.code, _bind_args(callee, args), callee.closure, callee.globals), None
+    if kind is BoundMethod:
+        fn = callee.function
+        if type(fn) is VMAsyncFunction:
+            return None, fn.start(_bind_args(fn, args, callee.receiver))
+        return _enter(fn, args, callee.receiver), None
+    if kind is VMAsyncFunction:
+        return None, callee.start(_bind_args(callee, args))
+    if kind is VMMemoFunction:
+        key = memo_key(args)
+        if key is not None:
+            value = callee.memo.get(key)
+            if value is not MISSING:
+                return None, value
+        fast = _bind_args(callee, args)
+        if key is not None:
+            # The last slot is the `<memo>` local that MEMO_STORE reads.
+            fast[-1] = (callee.memo, key)
+        return _frame(callee.code, fast, callee.closure, callee.globals), None
+    if kind is BoaClass:
+        inst = BoaInstance(callee)
+        init = callee.methods.get("__init__")
+        if init is None:
+            return None, inst
+        return _enter(init, args, inst, inst), None
+    if callable(callee):
+        return None, callee(*args)
+    raise RuntimeErrorBoa("Attempted to call non-callable value")
+
+
+def _stack_overflow(max_stack: int) -> RuntimeErrorBoa:
+    return RuntimeErrorBoa(f"Maximum call depth exceeded ({max_stack} frames; raise it with --max-stack)")
+
+
+class VM:
+    def __init__(
+        self,
+        env: Env | None = None,
+        profiler: Any = None,
+        max_stack: int = DEFAULT_MAX_STACK,
+        loader: Any = None,
+        out_buffer: int = DEFAULT_OUT_BUFFER,
+    ) -> None:
+        self.globals = env or Env()
+        # Receives the PROFILE_* events of code built with `profile=True`.
+        self.profiler = profiler
+        # Boa frames live on `_execute`'s own call stack, never the host's, so
+        # this alone bounds recursion depth.
+        self.max_stack = max_stack
+        # Resolves USE_MODULE (see `runtime.import_module`).
+        self.loader = loader
+        # Size limit of `output.STDOUT` while `run` executes.
+        self.out_buffer = out_buffer
+        install_builtins(self.globals, self.call)
+
+    def run(self, code: CodeObject) -> Env:
+        STDOUT.limit = self.out_buffer
+        try:
+            self.exec_module(code)
+        finally:
+            STDOUT.flush()
+            STDOUT.limit = DEFAULT_OUT_BUFFER
+        return self.globals
+
+    def exec_module(self, code: CodeObject) -> Env:
+        """Run the body of a module imported by the current `run` into this VM's globals.
+
+        Unlike `run`, it leaves `output.STDOUT` to the run that imported it.
+        """
+        self._execute(Frame(code, [UNBOUND] * len(code.varnames), (), self.globals.values))
+        return self.globals
+
+    def call(self, fn: Any, args: list[Any]) -> Any:
+        """Invoke a Boa callable from native code, e.g. a builtin callback."""
+        frame, result = _frame_for(fn, args)
+        return result if frame is None else self._execute(frame)
+
+    def _coroutine(self, frame: Frame) -> Generator[Any, Any, Any]:
+        """The steps of a coroutine for `scheduler`: run `frame`, suspending at each AWAIT."""
+        # An AWAIT only ever runs in an `afn` frame, and such a frame is only
+        # entered here, so it is always the bottom frame of its `_execute`.
+        while True:
+            result = self._execute(frame)
+            if type(result) is not _Suspend:
+                return result
+            frame.stack.append((yield from await_value(result.awaitable)))
+
+    def _execute(self, frame: Frame) -> Any:
+        callers: list[Frame] = []
+        binary = BINARY_FUNCS
+        globals_ = frame.globals
+        unbound = UNBOUND
+        max_stack = self.max_stack
+        out = STDOUT.line
+        free = _free_frames
+        # Call depth, in `callers`, beyond which the next call records a new peak.
+        peak = 0
+
+        code = frame.code
+        instructions = code.instructions
+        constants = code.constants
+        names = code.names
+        stack = frame.stack
+        push = stack.append
+        pop = stack.pop
+        fast = frame.fast
+        pc = frame.pc
+
+        # Positions are looked up only for an error, from the instruction
+        # that raised it in the innermost frame.
+        try:
+            while True:
+                op, arg = instructions[pc]
+                pc += 1
+
+                if op == LOAD_FAST:
+                    value = fast[arg]
+                    if value is unbound:
+                        value = _unbound_local(code.varnames[arg], globals_)
+                    push(value)
+                elif op == LOAD_CONST:
+                    push(constants[arg])
+                elif op == STORE_FAST:
+                    fast[arg] = pop()
+                elif op == BINARY_OP:
+                    right = pop()
+                    stack[-1] = binary[arg](stack[-1], right)
+                elif op == POP_JUMP_IF_FALSE:
+                    if not pop():
+                        pc = arg
+                elif op == JUMP:
+                    pc = arg
+                elif op == FOR_RANGE:
+                    try:
+                        fast[arg & FOR_RANGE_MASK] = next(stack[-1])
+                    except StopIteration:
+                        pop()
+                        pc = arg >> FOR_RANGE_SHIFT
+                elif op == FOR_ITER:
+                    try:
+                        push(next(stack[-1]))
+                    except StopIteration:
+                        pop()
+                        pc = arg
+                elif op == COMPARE_JUMP:
+                    right = pop()
+                    if not binary[arg & COMPARE_JUMP_MASK](pop(), right):
+                        pc = arg >> COMPARE_JUMP_SHIFT
+                elif op == CALL:
+                    args = stack[len(stack) - arg :]
+                    del stack[len(stack) - arg :]
+                    callee = pop()
+                    if type(callee) is VMFunction:
+                        if free:
+                            callee_frame = free.pop()
+                            callee_frame.code = callee.code
+                            callee_frame.fast = _bind_args(callee, args)
+                            callee_frame.closure = callee.closure
+                            callee_frame.globals = callee.globals
+                        else:
+                            callee_frame = Frame(callee.code, _bind_args(callee, args), callee.closure, callee.globals)
+                    else:
+                        callee_frame, value = _frame_for(callee, args)
+                        if callee_frame is None:
+                            push(value)
+                            continue
+
+                    if len(callers) >= peak:
+                        if len(callers) >= max_stack:
+                            raise _stack_overflow(max_stack)
+                        peak = len(callers) + 1
+                        STATS.reached(peak)
+                    frame.pc = pc
+                    callers.append(frame)
+                    frame = callee_frame
+                    code = frame.code
+                    instructions = code.instructions
+                    constants = code.constants
+                    names = code.names
+                    stack = frame.stack
+                    push = stack.append
+                    pop = stack.pop
+                    fast = frame.fast
+                    globals_ = frame.globals
+                    pc = 0
+                elif op == RETURN_VALUE:
+                    value = pop()
+                    if frame.init_instance is not None:
+                        value = frame.init_instance
+                    if not callers:
+                        return value
+                    if len(free) < POOL_SIZE:
+                        if stack:
+                            stack.clear()
+                        frame.init_instance = None
+                        free.append(frame)
+                    frame = callers.pop()
+                    code = frame.code
+                    instructions = code.instructions
+                    constants = code.constants
+                    names = code.names
+                    stack = frame.stack
+                    push = stack.append
+                    pop = stack.pop
+                    fast = frame.fast
+                    globals_ = frame.globals
+                    pc = frame.pc
+                    push(value)
+                elif op == MEMO_STORE:
+                    entry = fast[arg]
+                    if entry is not unbound:
+                        entry[0].store(entry[1], stack[-1])
+                elif op == LOAD_METHOD:
+                    target = stack[-1]
+                    site = code.sites.get(pc)
+                    if site is not None and type(target) is BoaInstance and target.cls is site[0]:
+                        if site[1] < 0 and target.extra is None:
+                            stack[-1] = site[2]
+                            push(target)
+                            continue
+                        if site[1] >= 0:
+                            value = target.values[site[1]]
+                            if value is not NO_FIELD:
+                                stack[-1] = value
+                                push(None)
+                                continue
+                    value, method = _member(target, names[arg], _site(code, pc))
+                    if method is None:
+                        # A field holding a callable: no receiver is bound.
+                        stack[-1] = value
+                        push(None)
+                    else:
+                        stack[-1] = method
+                        push(target)
+                elif op == CALL_METHOD:
+                    base = len(stack) - arg - 1
+                    callee = stack[base - 1]
+                    receiver = stack[base]
+                    if receiver is not None and type(callee) is VMFunction:
+                        # The receiver already sits right below the arguments, so
+                        # one slice is the callee's `[self, *args]` slot prefix.
+                        callee_code = callee.code
+                        local = stack[base:]
+                        del stack[base - 1 :]
+                        extra = len(callee_code.varnames) - len(local)
+                        if extra < 0 or len(local) != len(callee_code.params):
+                            _bind_args(callee, local[1:], local[0])
+                        if extra:
+                            local += [unbound] * extra
+                        if free:
+                            callee_frame = free.pop()
+                            callee_frame.code = callee_code
+                            callee_frame.fast = local
+                            callee_frame.closure = callee.closure
+                            callee_frame.globals = callee.globals
+                        else:
+                            callee_frame = Frame(callee_code, local, callee.closure, callee.globals)
+                    else:
+                        args = stack[base + 1 :]
+                        del stack[base - 1 :]
+                        if receiver is not None:
+                            callee = BoundMethod(callee, receiver)
+                        callee_frame, value = _frame_for(callee, args)
+                        if callee_frame is None:
+                            push(value)
+                            continue
+
+                    if len(callers) >= peak:
+                        if len(callers) >= max_stack:
+                            raise _stack_overflow(max_stack)
+                        peak = len(callers) + 1
+                        STATS.reached(peak)
+                    frame.pc = pc
+                    callers.append(frame)
+                    frame = callee_frame
+                    code = frame.code
+                    instructions = code.instructions
+                    constants = code.constants
+                    names = code.names
+                    stack = frame.stack
+                    push = stack.append
+                    pop = stack.pop
+                    fast = frame.fast
+                    globals_ = frame.globals
+                    pc = 0
+                elif op == TAIL_CALL:
+                    args = stack[len(stack) - arg :]
+                    del stack[len(stack) - arg :]
+                    callee_frame, value = _frame_for(pop(), args)
+                    if callee_frame is None:
+                        push(value)
+                        continue
+                    if frame.init_instance is not None:
+                        # `__init__` still has to return its instance afterwards.
+                        if len(callers) >= max_stack:
+                            raise _stack_overflow(max_stack)
+                        frame.pc = pc
+                        callers.append(frame)
+                    elif callers:
+                        # The bottom frame may belong to a coroutine or a
+                        # `pfor` worker; any other is finished here.
+                        _release(frame)
+                    frame = callee_frame
+                    code = frame.code
+                    instructions = code.instructions
+                    constants = code.constants
+                    names = code.names
+                    stack = frame.stack
+                    push = stack.append
+                    pop = stack.pop
+                    fast = frame.fast
+                    globals_ = frame.globals
+                    pc = 0
+                elif op == LOAD_GLOBAL:
+                    try:
+                        push(globals_[names[arg]])
+                    except KeyError:
+                        raise RuntimeErrorBoa(f"Unknown symbol '{names[arg]}'") from None
+                elif op == STORE_GLOBAL:
+                    globals_[names[arg]] = pop()
+                elif op == LOAD_DEREF:
+                    depth, slot, name = code.derefs[arg]
+                    value = frame.closure[depth - 1][slot]
+                    if value is unbound:
+                        value = _unbound_local(name, globals_)
+                    push(value)
+                elif op == POP_TOP:
+                    pop()
+                elif op == LOAD_ATTR:
+                    target = stack[-1]
+                    site = code.sites.get(pc)
+                    if site is not None and type(target) is BoaInstance and target.cls is site[0]:
+                        if site[1] >= 0:
+                            value = target.values[site[1]]
+                            if value is not NO_FIELD:
+                                stack[-1] = value
+                                continue
+                        elif target.extra is None:
+                            stack[-1] = BoundMethod(site[2], target)
+                            continue
+                    value, method = _member(target, names[arg], _site(code, pc))
+                    stack[-1] = value if method is None else BoundMethod(method, target)
+                elif op == STORE_ATTR:
+                    target = pop()
+                    value = pop()
+                    site = code.sites.get(pc)
+                    if site is not None and type(target) is BoaInstance and target.cls is site[0]:
+                        target.values[site[1]] = value
+                    else:
+                        store_member(target, names[arg], value, _site(code, pc))
+                elif op == OUT:
+                    out(pop())
+                elif op == UNARY_NEG:
+                    stack[-1] = -stack[-1]
+                elif op == UNARY_NOT:
+                    stack[-1] = not stack[-1]
+                elif op == TO_BOOL:
+                    stack[-1] = bool(stack[-1])
+                elif op == GET_ITER:
+                    stack[-1] = iter(stack[-1])
+                elif op == BUILD_LIST:
+                    items = stack[len(stack) - arg :]
+                    del stack[len(stack) - arg :]
+                    push(items)
+                elif op == BUILD_DICT:
+                    items = stack[len(stack) - 2 * arg :]
+                    del stack[len(stack) - 2 * arg :]
+                    push({items[i]: items[i + 1] for i in range(0, len(items), 2)})
+                elif op == FORMAT_VALUE:
+                    stack[-1] = str(stack[-1])
+                elif op == BUILD_STRING:
+                    parts = stack[len(stack) - arg :]
+                    del stack[len(stack) - arg :]
+                    push("".join(parts))
+                elif op == MAKE_FUNCTION:
+                    closure = (fast, *frame.closure) if code.varnames else frame.closure
+                    push(self._function(constants[arg], closure, globals_))
+                elif op == MAKE_CLASS:
+                    spec: ClassCode = constants[arg]
+                    base = None if spec.base_name is None else class_base(spec.name, pop())
+                    closure = (fast, *frame.closure) if code.varnames else frame.closure
+                    if base is not None:
+                        # The cell LOAD_SUPER reads; after every enclosing
+                        # frame's, so LOAD_DEREF depths are unchanged.
+                        closure = (*closure, [base])
+                    methods = {method.name: self._function(method, closure, globals_) for method in spec.methods}
+                    push(make_class(spec.name, base, methods, spec.fields))
+                elif op == LOAD_SUPER:
+                    push(super_method(frame.closure[-1][0], names[arg]))
+                elif op == PFOR:
+                    self._pfor(frame, pop(), pc)
+                    pc = arg
+                elif op == PAR_END:
+                    return None
+                elif op == PACK:
+                    stack[-1] = pack(stack[-1], PACKED_TYPES[arg])
+                elif op == AWAIT:
+                    frame.pc = pc
+                    return _Suspend(pop())
+                elif op == USE_MODULE:
+                    push(import_module(names[arg], self.loader))
+                elif op == PROFILE_LINE:
+                    self.profiler.line(arg)
+                elif op == PROFILE_ENTER:
+                    self.profiler.enter(code.name)
+                elif op == PROFILE_EXIT:
+                    self.profiler.exit()
+                else:
+                    raise RuntimeErrorBoa(f"Unknown opcode {op}")
+        except RuntimeErrorBoa as exc:
+            if not exc.span:
+                exc.span = code.span_at(pc - 1)
+            raise
+
+
+    def _pfor(self, frame: Frame, iterable: Any, top: int) -> None:
+        """Run the `pfor` loop at `top` over `iterable`, a worker frame per chunk."""
+        items = list(iterable)
+
+        def task(start: int, stop: int) -> None:
+            # The worker frame shares `frame`'s variables; semantic analysis
+            # keeps everything the body assigns private to its iteration.
+            worker = Frame(frame.code, frame.fast, frame.closure, frame.globals)
+            worker.pc = top
+            worker.stack.append(iter(items[start:stop]))
+            self._execute(worker)
+
+        run_chunks(len(items), task, sequential=self.profiler is not None)
+
+    def _function(
+        self, code: CodeObject, closure: tuple[list[Any], ...], globals_: dict[str, Any]
+    ) -> VMFunction:
+        if code.is_async:
+            return VMAsyncFunction(code, closure, globals_, self)
+        if code.memo:
+            return VMMemoFunction(code, closure, globals_)
+        if code.native is not None:
+            return code.native.bind(VMFunction(code, closure, globals_), self)
+        return VMFunction(code, closure, globals_)
+
+
+def run_code(
+    code: CodeObject,
+    env: Env | None = None,
+    profiler: Any = None,
+    max_stack: int = DEFAULT_MAX_STACK,
+    loader: Any = None,
+    out_buffer: int = DEFAULT_OUT_BUFFER,
+) -> Env:
+    return VM(env, profiler, max_stack, loader, out_buffer).run(code)
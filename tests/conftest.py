@@ -0,0 +1,11 @@
+"""Shared pytest fixtures."""
+
+from __future__ import annotations
+
+import pytest
+
+
+@pytest.fixture(autouse=True)
+def _isolated_compile_cache(tmp_path_factory: pytest.TempPathFactory, monkeypatch: pytest.MonkeyPatch) -> None:
+    # Keep tests from reading or populating the user's real compile cache.
+    monkeypatch.setenv("BOA_CACHE_DIR", str(tmp_path_factory.mktemp("boa-cache")))
@@ -0,0 +1,88 @@
+"""Tests for packed `[i]`/`[f]` arrays."""
+
+from __future__ import annotations
+
+from io import StringIO
+import sys
+
+import pytest
+
+from boa.arrays import TypedArray, pack
+from boa.bytecode import compile_program
+from boa.parser import parse_source
+from boa.runtime import eval_program
+from boa.vm import run_code
+
+PROGRAM = """nums: [i] = [1, 2, 3]
+ratios: [f] = [0.5, -0.0]
+mixed: [f] = [1, 2.5]
+flags: [i] = [yes, 1]
+fn total(xs: [i]) -> i:
+    t = 0
+    for x ~ xs:
+        t = t + x
+    ret t
+more = nums + [4]
+out nums
+out ratios
+out mixed
+out len(nums)
+out 2 ~ nums
+out nums == [1, 2, 3]
+out more
+out nums + [4.5]
+out 2 * nums
+out total([5, 6]) + total(more)
+"""
+
+EXPECTED = [
+    "[1, 2, 3]",
+    "[0.5, -0.0]",
+    "[1, 2.5]",
+    "3",
+    "True",
+    "True",
+    "[1, 2, 3, 4]",
+    "[1, 2, 3, 4.5]",
+    "[1, 2, 3, 1, 2, 3]",
+    "21",
+]
+
+
+def _run(engine: str) -> tuple[dict, list[str]]:
+    program = parse_source(PROGRAM)
+    old = sys.stdout
+    sys.stdout = buf = StringIO()
+    try:
+        env = eval_program(program) if engine == "tree" else run_code(compile_program(program))
+    finally:
+        sys.stdout = old
+    return env.values, buf.getvalue().splitlines()
+
+
+def test_pack_only_lists_of_exactly_the_element_type() -> None:
+    packed = pack([1, 2, 3], "[i]")
+    assert type(packed) is TypedArray and packed.typecode == "q"
+    assert packed.data.itemsize == 8
+    assert type(pack([1.0, 2.5], "[f]")) is TypedArray
+    for value, annotation in [([1, 2.5], "[f]"), ([True], "[i]"), ([2**63], "[i]"), ("abc", "[i]")]:
+        assert pack(value, annotation) is value
+
+
+@pytest.mark.parametrize("engine", ["vm", "tree"])
+def test_annotated_bindings_are_packed_and_read_like_lists(engine: str) -> None:
+    values, lines = _run(engine)
+    assert lines == EXPECTED
+    assert type(values["nums"]) is TypedArray and type(values["ratios"]) is TypedArray
+    # Appending ints keeps the array packed; a float element falls back to a list.
+    assert type(values["more"]) is TypedArray
+    assert type(values["mixed"]) is list and type(values["flags"]) is list
+
+
+def test_typed_array_orders_and_compares_like_a_list() -> None:
+    packed = pack([1, 2], "[i]")
+    assert packed == [1, 2] and [1, 2] == packed and packed != [1, 2, 3]
+    assert packed < [1, 3] and [1, 3] > packed and packed >= pack([1], "[i]")
+    assert packed[1] == 2 and packed[:1] == [1]
+    with pytest.raises(TypeError):
+        hash(packed)
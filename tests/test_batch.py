@@ -0,0 +1,61 @@
+"""Tests for multi-file `check`/`build`."""
+
+from __future__ import annotations
+
+from pathlib import Path
+
+import pytest
+
+from boa.batch import UNCHANGED, build_files, expand_sources
+from boa.cli import main
+
+
+def _tree(root: Path) -> None:
+    for rel, text in {
+        "app/main.boa": "out 1\n",
+        "app/lib/util.boa": "fn two() -> i:\n    ret 2\n",
+        "app/lib/bad.boa": "break\n",
+        "app/notes.txt": "not boa\n",
+        "other/x.boa": "x = 1\n",
+    }.items():
+        path = root / rel
+        path.parent.mkdir(parents=True, exist_ok=True)
+        path.write_text(text, encoding="utf-8")
+
+
+def test_expand_sources_walks_directories_and_globs(tmp_path: Path) -> None:
+    _tree(tmp_path)
+    app = tmp_path / "app"
+    found = expand_sources([str(app), str(tmp_path / "*" / "*.boa"), str(app / "main.boa")])
+    assert [p.relative_to(tmp_path).as_posix() for p in found] == [
+        "app/lib/bad.boa",
+        "app/lib/util.boa",
+        "app/main.boa",
+        "other/x.boa",
+    ]
+    with pytest.raises(FileNotFoundError):
+        expand_sources([str(tmp_path / "*.nothing")])
+
+
+def test_check_aggregates_diagnostics_and_skips_unchanged(
+    tmp_path: Path, monkeypatch: pytest.MonkeyPatch, capsys: pytest.CaptureFixture[str]
+) -> None:
+    monkeypatch.setenv("BOA_CACHE_DIR", str(tmp_path / "cache"))
+    _tree(tmp_path)
+    assert main(["check", str(tmp_path), "-j", "2"]) == 1
+    captured = capsys.readouterr()
+    assert "bad.boa: 'break' used outside loop" in captured.err
+    assert captured.out.strip() == "Checked 4 file(s): 3 ok, 0 unchanged, 1 failed"
+    (tmp_path / "app" / "lib" / "bad.boa").write_text("..\n", encoding="utf-8")
+    assert main(["check", str(tmp_path), "-j", "2"]) == 0
+    assert capsys.readouterr().out.strip() == "Checked 4 file(s): 1 ok, 3 unchanged, 0 failed"
+
+
+def test_build_leaves_up_to_date_artifacts_alone(tmp_path: Path) -> None:
+    _tree(tmp_path)
+    paths = expand_sources([str(tmp_path / "other"), str(tmp_path / "app" / "main.boa")])
+    assert all(r.status == "ok" for r in build_files(paths, jobs=2))
+    artifact = tmp_path / "app" / "main.boac"
+    stamp = artifact.stat().st_mtime_ns
+    assert all(r.status == UNCHANGED for r in build_files(paths, jobs=2, use_cache=False))
+    assert artifact.stat().st_mtime_ns == stamp
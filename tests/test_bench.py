@@ -0,0 +1,54 @@
+"""Tests for the benchmark harness."""
+
+from __future__ import annotations
+
+import json
+from pathlib import Path
+
+import pytest
+
+from boa.bench import PHASES, bench_program, discover, synthetic_source
+from boa.cli import main
+from boa.parser import parse_source
+
+
+def test_bench_program_reports_phases_and_ops() -> None:
+    src = "# bench: ops=100\ntotal = 0\nfor x ~ range(100):\n    total = total + x\nout total\n"
+    result = bench_program("sum", src, repeat=1)
+    assert set(result["phases"]) == set(PHASES)
+    assert result["ops"] == 100
+    assert result["ops_per_second"] > 0
+    assert result["peak_bytes"] > 0
+
+
+def test_discover_expands_directories(tmp_path: Path) -> None:
+    (tmp_path / "b.boa").write_text("out 1\n", encoding="utf-8")
+    (tmp_path / "a.boa").write_text("out 2\n", encoding="utf-8")
+    (tmp_path / "notes.txt").write_text("", encoding="utf-8")
+    assert [p.name for p in discover([tmp_path])] == ["a.boa", "b.boa"]
+
+
+def test_synthetic_source_parses() -> None:
+    assert len(parse_source(synthetic_source(3)).statements) == 4
+
+
+def test_cli_bench_suite_writes_json(tmp_path: Path, capsys: pytest.CaptureFixture[str]) -> None:
+    (tmp_path / "tiny.boa").write_text("# bench: ops=1\nout 1 + 1\n", encoding="utf-8")
+    report_path = tmp_path / "report.json"
+    code = main(
+        [
+            "bench",
+            "suite",
+            str(tmp_path),
+            "--repeat",
+            "1",
+            "--json",
+            "--no-large-parse",
+            "--output",
+            str(report_path),
+        ]
+    )
+    printed = json.loads(capsys.readouterr().out)
+    assert code == 0
+    assert printed == json.loads(report_path.read_text(encoding="utf-8"))
+    assert [b["name"] for b in printed["benchmarks"]] == ["tiny"]
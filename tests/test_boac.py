@@ -0,0 +1,51 @@
+"""Tests for the binary .boac artifact format."""
+
+from __future__ import annotations
+
+import struct
+
+import pytest
+
+from boa import boac
+from boa.compiler import compile_source
+
+
+def test_roundtrip_preserves_code_and_constants() -> None:
+    src = (
+        "cls Box:\n"
+        "    fn __init__(s):\n"
+        "        s.size = 7\n"
+        "    fn get(s) -> i:\n"
+        "        ret s.size\n"
+        "fn f(a: i) -> f:\n"
+        "    ret a * 2.5 + 12345678901234567890\n"
+        "afn g():\n"
+        "    ..\n"
+        "out f(2)\n"
+        "out nil\n"
+    )
+    code = compile_source(src)
+    loaded = boac.loads(boac.dumps(code))
+    assert loaded.instructions == code.instructions
+    assert loaded.names == code.names
+    fn_code = next(c for c in loaded.constants if isinstance(c, type(code)))
+    assert fn_code.params == ["a"]
+    assert not fn_code.is_async
+    assert next(c for c in loaded.constants if getattr(c, "name", None) == "g").is_async
+    assert 2.5 in fn_code.constants
+    assert 12345678901234567890 in fn_code.constants
+    box = next(c for c in loaded.constants if isinstance(c, boac.ClassCode))
+    assert box.fields == ["size"]
+
+
+def test_rejects_other_format_version() -> None:
+    data = bytearray(boac.dumps(compile_source("out 1\n")))
+    struct.pack_into("<H", data, 4, boac.FORMAT_VERSION + 1)
+    with pytest.raises(boac.BoacError):
+        boac.loads(bytes(data))
+
+
+def test_rejects_truncated_artifact() -> None:
+    data = boac.dumps(compile_source("out 1\n"))
+    with pytest.raises(boac.BoacError):
+        boac.loads(data[: len(data) // 2])
@@ -0,0 +1,62 @@
+"""Tests for the on-disk compile cache."""
+
+from __future__ import annotations
+
+from pathlib import Path
+
+import pytest
+
+from boa import cache
+from boa.cli import main
+
+
+def _write(tmp_path: Path, text: str) -> Path:
+    src = tmp_path / "job.boa"
+    src.write_text(text, encoding="utf-8")
+    return src
+
+
+def test_run_hit_skips_parsing(
+    tmp_path: Path, monkeypatch: pytest.MonkeyPatch, capsys: pytest.CaptureFixture[str]
+) -> None:
+    monkeypatch.setenv("BOA_CACHE_DIR", str(tmp_path / "cache"))
+    src = _write(tmp_path, "out 6 * 7\n")
+    assert main(["run", str(src)]) == 0
+    assert len(list((tmp_path / "cache").glob("*.boac"))) == 1
+
+    def fail_parse(_source: str) -> None:
+        raise AssertionError("cache hit should not re-parse")
+
+    monkeypatch.setattr("boa.compiler.parse_source", fail_parse)
+    assert main(["run", str(src)]) == 0
+    assert main(["check", str(src)]) == 0
+    assert capsys.readouterr().out.splitlines()[:2] == ["42", "42"]
+
+
+def test_edit_misses_and_no_cache_bypasses(tmp_path: Path, monkeypatch: pytest.MonkeyPatch) -> None:
+    monkeypatch.setenv("BOA_CACHE_DIR", str(tmp_path / "cache"))
+    src = _write(tmp_path, "out 1\n")
+    assert main(["run", str(src)]) == 0
+    src.write_text("out 2\n", encoding="utf-8")
+    assert main(["run", str(src), "--no-cache"]) == 0
+    assert len(list((tmp_path / "cache").glob("*.boac"))) == 1
+    assert main(["run", str(src)]) == 0
+    assert len(list((tmp_path / "cache").glob("*.boac"))) == 2
+
+
+def test_cache_clear_removes_entries(tmp_path: Path, monkeypatch: pytest.MonkeyPatch) -> None:
+    monkeypatch.setenv("BOA_CACHE_DIR", str(tmp_path / "cache"))
+    src = _write(tmp_path, "out 1\n")
+    assert main(["check", str(src)]) == 0
+    assert cache.lookup(src.read_bytes()) is not None
+    assert main(["cache", "clear"]) == 0
+    assert cache.lookup(src.read_bytes()) is None
+
+
+def test_corrupt_entry_is_recompiled(tmp_path: Path, monkeypatch: pytest.MonkeyPatch) -> None:
+    monkeypatch.setenv("BOA_CACHE_DIR", str(tmp_path / "cache"))
+    data = b"out 1\n"
+    entry = cache.entry_path(data)
+    entry.parent.mkdir(parents=True)
+    entry.write_bytes(b"BOAC garbage")
+    assert cache.lookup(data) is None
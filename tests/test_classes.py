@@ -0,0 +1,131 @@
+"""Tests for class inheritance and `super()`."""
+
+from __future__ import annotations
+
+from io import StringIO
+from pathlib import Path
+import sys
+
+import pytest
+
+from boa import boac
+from boa.compiler import compile_source, run_source
+from boa.parser import parse_source
+from boa.runtime import BoaClass, RuntimeErrorBoa, eval_program
+from boa.semantic import SemanticError, analyze
+from boa.vm import run_code
+
+SAMPLE = Path(__file__).resolve().parent / "samples" / "classes.boa"
+
+HIERARCHY = (
+    "cls A:\n"
+    "    fn __init__(s, x):\n"
+    "        s.x = x\n"
+    "    fn who(s):\n"
+    '        ret "A"\n'
+    "    fn describe(s):\n"
+    '        ret f"{s.who()} {s.x}"\n'
+    "cls B(A):\n"
+    "    fn __init__(s, x, y):\n"
+    "        super().__init__(x)\n"
+    "        s.y = y\n"
+    "    fn who(s):\n"
+    '        ret "B" + super().who()\n'
+    "cls C(B):\n"
+    "    fn who(s):\n"
+    '        ret "C" + super().who()\n'
+    "fn make(n):\n"
+    "    cls L(C):\n"
+    "        fn who(s):\n"
+    '            ret f"L{n}" + super().who()\n'
+    "    ret L(n, 0)\n"
+)
+
+
+def _output(source: str, engine: str) -> list[str]:
+    old = sys.stdout
+    sys.stdout = buf = StringIO()
+    try:
+        run_source(source, engine)
+    finally:
+        sys.stdout = old
+    return buf.getvalue().splitlines()
+
+
+@pytest.mark.parametrize("engine", ["vm", "tree"])
+def test_methods_and_fields_are_inherited(engine: str) -> None:
+    source = HIERARCHY + (
+        "for o ~ [A(1), B(2, 3), C(4, 5), make(7), make(8)]:\n"
+        "    out o.describe()\n"
+        "out C(1, 9).y\n"
+    )
+    assert _output(source, engine) == ["A 1", "BA 2", "CBA 4", "L7CBA 7", "L8CBA 8", "9"]
+    assert _output(SAMPLE.read_text(encoding="utf-8"), engine) == ["Rex says Woof"]
+
+
+@pytest.mark.parametrize("engine", ["vm", "tree"])
+def test_super_inside_an_fstring_field(engine: str) -> None:
+    source = (
+        "cls Animal:\n"
+        "    fn speak(s):\n"
+        '        ret "Woof"\n'
+        "cls Dog(Animal):\n"
+        "    fn speak(s):\n"
+        '        ret f"bark {super().speak()}"\n'
+        "out Dog().speak()\n"
+    )
+    assert _output(source, engine) == ["bark Woof"]
+
+
+def test_classes_flatten_their_base_once() -> None:
+    program = parse_source(HIERARCHY)
+    analyze(program)
+    env = eval_program(program)
+    a, b, c = (env.get(name) for name in "ABC")
+    assert isinstance(c, BoaClass) and c.base is b and b.base is a
+    assert set(c.methods) == {"__init__", "who", "describe"}
+    assert c.methods["__init__"] is b.methods["__init__"]
+    assert c.methods["describe"] is a.methods["describe"]
+    assert a.layout == {"x": 0} and b.layout == c.layout == {"x": 0, "y": 1}
+    vm_c = run_code(compile_source(HIERARCHY)).get("C")
+    assert vm_c.layout == c.layout and set(vm_c.methods) == set(c.methods)
+
+
+@pytest.mark.parametrize(
+    "source",
+    [
+        "cls A:\n    fn f(s):\n        ret super().f()\n",
+        "fn f(s):\n    ret super().f()\n",
+        "cls A:\n    ..\ncls B(A):\n    fn f(s):\n        fn g():\n            ret super().f()\n        ret g\n",
+    ],
+)
+def test_reject_super_outside_a_subclass_method(source: str) -> None:
+    with pytest.raises(SemanticError, match=r"'super\(\)' used outside"):
+        analyze(parse_source(source))
+
+
+def test_duplicate_symbols_are_per_scope() -> None:
+    analyze(parse_source("cls A:\n    fn __init__(s):\n        ..\ncls B:\n    fn __init__(s):\n        ..\n"))
+    analyze(parse_source("fn helper():\n    ..\nfn f():\n    fn helper():\n        ..\n    ret helper\n"))
+    with pytest.raises(SemanticError, match="Duplicate symbol 'f'"):
+        analyze(parse_source("cls A:\n    fn f(s):\n        ..\n    fn f(s):\n        ..\n"))
+
+
+@pytest.mark.parametrize("engine", ["vm", "tree"])
+def test_base_errors_are_runtime_errors(engine: str) -> None:
+    with pytest.raises(RuntimeErrorBoa, match="Base of class 'D' must be a class, not int"):
+        run_source("x = 1\ncls D(x):\n    ..\n", engine)
+    source = "cls A:\n    ..\ncls B(A):\n    fn f(s):\n        ret super().g()\nB().f()\n"
+    with pytest.raises(RuntimeErrorBoa, match="Base class 'A' has no method 'g'"):
+        run_source(source, engine)
+
+
+def test_boac_keeps_the_base() -> None:
+    code = boac.loads(boac.dumps(compile_source(HIERARCHY + "out make(3).describe()\n")))
+    old = sys.stdout
+    sys.stdout = buf = StringIO()
+    try:
+        run_code(code)
+    finally:
+        sys.stdout = old
+    assert buf.getvalue() == "L3CBA 3\n"
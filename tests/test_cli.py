@@ -3,6 +3,8 @@
 from __future__ import annotations
 
 from pathlib import Path
+import json
+import os
 import stat
 import subprocess
 import sys
@@ -29,6 +31,48 @@ def test_cli_build_emits_boac(tmp_path: Path) -> None:
     assert out.exists()
 
 
+def test_cli_build_output_path(tmp_path: Path, capsys: pytest.CaptureFixture[str]) -> None:
+    src = tmp_path / "ok.boa"
+    src.write_text("out 40 + 2\n", encoding="utf-8")
+    other = tmp_path / "other.boa"
+    other.write_text("out 1\n", encoding="utf-8")
+    assert main(["build", str(src), "-o", str(tmp_path / "app.bin")]) == 0
+    assert main(["build", str(src), str(tmp_path / "app2")]) == 0
+    assert (tmp_path / "app.bin").exists() and (tmp_path / "app2").exists()
+    assert not (tmp_path / "ok.boac").exists()
+    # A second `.boa` name is a second source, not an output.
+    assert main(["build", str(src), str(other)]) == 0
+    assert (tmp_path / "ok.boac").exists() and (tmp_path / "other.boac").exists()
+    capsys.readouterr()
+    assert main(["build", str(src), str(other), "-o", str(tmp_path / "both.boac")]) == 1
+    assert "exactly one source" in capsys.readouterr().err
+    assert main(["run", str(tmp_path / "app.bin")]) == 0
+    assert capsys.readouterr().out.strip() == "42"
+
+
+def test_cli_runs_prebuilt_boac(tmp_path: Path, capsys: pytest.CaptureFixture[str]) -> None:
+    src = tmp_path / "ok.boa"
+    src.write_text("out 40 + 2\n", encoding="utf-8")
+    out = tmp_path / "ok.boac"
+    assert main(["build", str(src), str(out)]) == 0
+    src.unlink()
+    capsys.readouterr()
+
+    code = main(["run", str(out)])
+    assert code == 0
+    assert capsys.readouterr().out.strip() == "42"
+
+
+def test_cli_bench_lex_json(tmp_path: Path, capsys: pytest.CaptureFixture[str]) -> None:
+    src = tmp_path / "big.boa"
+    src.write_text("x: i = 1 + 2\n" * 50, encoding="utf-8")
+    code = main(["bench", "lex", str(src), "--repeat", "1", "--json"])
+    report = json.loads(capsys.readouterr().out)
+    assert code == 0
+    assert report["tokens"] == 50 * 8 + 1
+    assert report["stream_peak_bytes"] < report["eager_peak_bytes"]
+
+
 def test_cli_script_mode_version() -> None:
     cli_path = Path(__file__).resolve().parents[1] / "src" / "boa" / "cli.py"
     result = subprocess.run(
@@ -136,3 +180,40 @@ def test_cli_install_sets_user_executable_bit(
 
     assert code == 0
     assert destination.stat().st_mode & stat.S_IXUSR
+
+
+def test_cli_version_and_help_do_not_import_the_compiler() -> None:
+    src_dir = Path(__file__).resolve().parents[1] / "src"
+    probe = (
+        "import sys\n"
+        "from boa.cli import main\n"
+        "main(['version'])\n"
+        "main(['help'])\n"
+        "print(sorted(name for name in sys.modules if name in ('boa.compiler', 'boa.runtime', 'boa.parser')))\n"
+    )
+    result = subprocess.run(
+        [sys.executable, "-c", probe],
+        capture_output=True,
+        text=True,
+        check=False,
+        env=dict(os.environ, PYTHONPATH=str(src_dir)),
+    )
+    assert result.returncode == 0
+    assert result.stdout.splitlines()[-1] == "[]"
+
+
+def test_cli_install_copies_a_one_dir_bundle(tmp_path: Path, monkeypatch: pytest.MonkeyPatch) -> None:
+    source = tmp_path / "dist" / "boa"
+    bundle = tmp_path / "dist" / "_internal"
+    bundle.mkdir(parents=True)
+    source.write_text("boa", encoding="utf-8")
+    (bundle / "base_library.zip").write_text("lib", encoding="utf-8")
+
+    monkeypatch.setattr("boa.cli._current_installable_path", lambda: source)
+    monkeypatch.setattr("boa.cli._bundle_dir", lambda: bundle)
+    destination = tmp_path / "bin" / "boa"
+    code = main(["install", str(destination)])
+
+    assert code == 0
+    assert destination.read_text(encoding="utf-8") == "boa"
+    assert (tmp_path / "bin" / "_internal" / "base_library.zip").read_text(encoding="utf-8") == "lib"
@@ -0,0 +1,48 @@
+"""Tests for incrementally checked documents."""
+
+from __future__ import annotations
+
+from boa.document import Diagnostic, Document
+
+SOURCE = (
+    "fn one() -> i:\n"
+    "    ret 1\n"
+    "\n"
+    "if yes:\n"
+    "    out one()\n"
+    "else:\n"
+    "    out 2\n"
+    "# note\n"
+    "fn two() -> i:\n"
+    "    ret 2\n"
+)
+
+
+def _fresh(document: Document) -> list[Diagnostic]:
+    return Document(document.text).diagnostics()
+
+
+def test_edits_match_a_fresh_check() -> None:
+    doc = Document(SOURCE)
+    assert doc.diagnostics() == []
+    doc.edit(1, 4, 1, 9, "break")
+    assert doc.diagnostics() == [Diagnostic(1, 0, "'break' used outside loop")]
+    doc.edit(0, 0, 0, 0, "cls two:\n    ..\n")
+    assert [d.message for d in doc.diagnostics()] == ["'break' used outside loop", "Duplicate symbol 'two'"]
+    assert doc.diagnostics() == _fresh(doc)
+    chunks = len(doc._chunks)
+    doc.edit(5, 0, 5, 0, "    ")  # indents the `if` into the body of `fn one`
+    assert len(doc._chunks) == chunks - 1
+    assert doc.diagnostics() == _fresh(doc)
+    doc.set_text(SOURCE)
+    assert doc.diagnostics() == []
+
+
+def test_edit_reparses_only_the_touched_declaration() -> None:
+    doc = Document(SOURCE)
+    before = list(doc._chunks)
+    doc.edit(9, 8, 9, 9, "20")
+    after = doc._chunks
+    assert len(after) == len(before)
+    assert after[:-1] == before[:-1] and after[-1] is not before[-1]
+    assert doc.line(9) == "    ret 20"
@@ -0,0 +1,71 @@
+"""Tests for the `lines`, `split` and `field` builtins."""
+
+from __future__ import annotations
+
+from io import StringIO
+from pathlib import Path
+import sys
+
+import pytest
+
+from boa import files
+from boa.compiler import run_source
+from boa.runtime import RuntimeErrorBoa
+
+
+def _output(source: str, engine: str = "vm") -> list[str]:
+    old = sys.stdout
+    sys.stdout = buf = StringIO()
+    try:
+        run_source(source, engine)
+    finally:
+        sys.stdout = old
+    return buf.getvalue().splitlines()
+
+
+def test_lines_match_splitting_the_whole_file(tmp_path: Path, monkeypatch: pytest.MonkeyPatch) -> None:
+    monkeypatch.setattr(files, "BLOCK_SIZE", 16)
+    text = "short\n" + "x" * 40 + "\n\nwindows\r\nlast é line"
+    path = tmp_path / "in.txt"
+    path.write_bytes(text.encode("utf-8"))
+    expected = text.replace("\r\n", "\n").split("\n")
+    assert list(files._lines(str(path))) == expected
+    path.write_bytes(text.encode("utf-8") + b"\n")
+    assert list(files._lines(str(path))) == expected
+    path.write_bytes(b"")
+    assert list(files._lines(str(path))) == []
+    path.write_bytes(b"ok\n\xff\n")
+    assert list(files._lines(str(path))) == ["ok", "�"]
+
+
+@pytest.mark.parametrize("engine", ["vm", "tree"])
+def test_a_loop_streams_fields_of_each_line(tmp_path: Path, engine: str) -> None:
+    path = tmp_path / "access.log"
+    path.write_text("web1 GET /a 200\nweb2 GET /b 500\nweb1 POST /c 500\n")
+    source = (
+        "errors = 0\n"
+        f'for line ~ lines("{path}"):\n'
+        '    if field(line, -1) == "500":\n'
+        "        errors = errors + 1\n"
+        "        out field(line, 0)\n"
+        "out errors\n"
+        'out split("a,b,,c", ",")\n'
+        'out field("a b", 2)\n'
+    )
+    assert _output(source, engine) == ["web2", "web1", "2", "['a', 'b', '', 'c']", "None"]
+
+
+def test_field_splits_only_as_far_as_needed() -> None:
+    assert files._field("  a  b c ", 1) == "b"
+    assert files._field("a,b,c", -2, ",") == "b"
+    assert files._field("a,b,c", 3, ",") is None
+    assert files._field("a,b,c", -4, ",") is None
+    with pytest.raises(RuntimeErrorBoa, match="index must be an integer"):
+        files._field("a", "0")
+    with pytest.raises(RuntimeErrorBoa, match="separator must be a non-empty string"):
+        files._split("a", "")
+
+
+def test_a_missing_file_is_a_runtime_error(tmp_path: Path) -> None:
+    with pytest.raises(RuntimeErrorBoa, match=r"lines\(\) cannot open '.*nope.log': No such file"):
+        run_source(f'for line ~ lines("{tmp_path / "nope.log"}"):\n    out line\n')
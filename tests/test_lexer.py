@@ -1,6 +1,8 @@
 """Tests for the standalone Boa lexer."""
 
-from boa.lexer import tokenize
+import pytest
+
+from boa.lexer import iter_tokens, tokenize
 
 
 def test_tokenize_keywords_and_identifiers() -> None:
@@ -17,3 +19,27 @@ def test_tokenize_operators() -> None:
     assert ".." in values
     assert "&&" in values
     assert "!" in values
+
+
+def test_iter_tokens_is_lazy_and_matches_tokenize() -> None:
+    src = "fn f(x: i) -> i:\n    ret x * 2  # double\n\nout f\"{f(2)}\"\n"
+    stream = iter_tokens(src)
+    first = next(stream)
+    assert (first.kind, first.value) == ("KEYWORD", "fn")
+    assert [first, *stream] == tokenize(src)
+    assert list(iter_tokens(src.splitlines(keepends=True))) == tokenize(src)
+
+
+def test_fstrings_have_their_own_token_kind() -> None:
+    tokens = [t for t in tokenize('a = "foo"\nb = f"x{a}"\n') if t.kind in {"STRING", "FSTRING"}]
+    assert [(t.kind, t.value) for t in tokens] == [("STRING", "foo"), ("FSTRING", "x{a}")]
+
+
+def test_tokenize_identity_operators() -> None:
+    values = [t.value for t in tokenize("a ==: b\nc !==: d\n") if t.kind == "OP"]
+    assert values == ["==:", "!==:"]
+
+
+def test_tokenize_reports_unterminated_string() -> None:
+    with pytest.raises(ValueError, match="Unterminated string at line 2"):
+        tokenize("x = 1\ny = \"abc\n")
@@ -0,0 +1,45 @@
+"""Tests for the `boa lsp` server."""
+
+from __future__ import annotations
+
+from io import BytesIO
+import json
+
+from boa.lsp import read_message, serve, write_message
+
+
+def _session(*messages: dict) -> list[dict]:
+    requests = BytesIO()
+    for message in messages:
+        write_message(requests, {"jsonrpc": "2.0", **message})
+    requests.seek(0)
+    replies = BytesIO()
+    assert serve(requests, replies) == 0
+    replies.seek(0)
+    out = []
+    while (message := read_message(replies)) is not None:
+        out.append(message)
+    return out
+
+
+def test_lsp_publishes_incremental_diagnostics() -> None:
+    uri = "file:///tmp/app.boa"
+    change = {"range": {"start": {"line": 1, "character": 4}, "end": {"line": 1, "character": 9}}, "text": "break"}
+    replies = _session(
+        {"id": 1, "method": "initialize", "params": {}},
+        {"method": "initialized", "params": {}},
+        {"method": "textDocument/didOpen", "params": {"textDocument": {"uri": uri, "text": "fn f():\n    ret 1\n"}}},
+        {"method": "textDocument/didChange", "params": {"textDocument": {"uri": uri}, "contentChanges": [change]}},
+        {"id": 2, "method": "textDocument/hover", "params": {}},
+        {"id": 3, "method": "shutdown"},
+        {"method": "exit"},
+    )
+    init, opened, changed, unsupported, shutdown = replies
+    assert init["result"]["capabilities"]["textDocumentSync"]["change"] == 2
+    assert opened["params"]["diagnostics"] == []
+    [diagnostic] = changed["params"]["diagnostics"]
+    assert diagnostic["message"] == "'break' used outside loop"
+    assert diagnostic["range"] == {"start": {"line": 1, "character": 0}, "end": {"line": 1, "character": 9}}
+    assert unsupported["error"]["code"] == -32601
+    assert shutdown == {"jsonrpc": "2.0", "id": 3, "result": None}
+    assert json.dumps(replies)
@@ -0,0 +1,84 @@
+"""Tests for `memo fn` result caching."""
+
+from __future__ import annotations
+
+from io import StringIO
+import sys
+
+import pytest
+
+from boa import boac
+from boa.compiler import compile_source, run_source
+from boa.memo import MISSING, MemoCache, memo_key
+from boa.parser import parse_source
+from boa.semantic import SemanticError, analyze
+
+
+def _output(source: str, engine: str) -> list[str]:
+    old = sys.stdout
+    sys.stdout = buf = StringIO()
+    try:
+        run_source(source, engine)
+    finally:
+        sys.stdout = old
+    return buf.getvalue().splitlines()
+
+
+@pytest.mark.parametrize("engine", ["vm", "tree"])
+def test_repeated_calls_reuse_the_first_result(engine: str) -> None:
+    # Without the cache, fib(80) would make some 10^16 calls.
+    source = (
+        "memo fn fib(n: i) -> i:\n"
+        "    if n < 2:\n"
+        "        ret n\n"
+        "    ret fib(n - 1) + fib(n - 2)\n"
+        "out fib(80)\n"
+        "out fib(80)\n"
+        "memo fn show(x):\n"
+        '    ret f"{x}"\n'
+        "out show(1)\n"
+        "out show(1.0)\n"
+        "out show(yes)\n"
+        "out show([1])\n"
+    )
+    assert _output(source, engine) == ["23416728348467685", "23416728348467685", "1", "1.0", "True", "[1]"]
+
+
+@pytest.mark.parametrize("engine", ["vm", "tree"])
+def test_zero_and_negative_zero_are_separate_entries(engine: str) -> None:
+    source = 'memo fn g(x: f) -> s:\n    ret f"{x}"\nout g(0.0)\nout g(-0.0)\nout g(0.0)\n'
+    assert _output(source, engine) == ["0.0", "-0.0", "0.0"]
+
+
+def test_the_least_recently_used_entry_is_dropped() -> None:
+    cache = MemoCache(2)
+    cache.store((1, int), "one")
+    cache.store((2, int), "two")
+    assert cache.get((1, int)) == "one"
+    cache.store((3, int), "three")
+    assert cache.get((2, int)) is MISSING
+    assert (cache.get((1, int)), cache.get((3, int))) == ("one", "three")
+    assert memo_key([1]) != memo_key([True]) != memo_key([1.0])
+    assert memo_key([0.0]) != memo_key([-0.0])
+    assert memo_key([[1]]) is None
+
+
+@pytest.mark.parametrize(
+    "source",
+    [
+        "memo fn f(x):\n    out x\n    ret x\n",
+        'memo fn f(x):\n    if x:\n        ret ask("? ")\n    ret x\n',
+        "memo fn f(b):\n    b.size = 1\n    ret b\n",
+        "cls Box:\n    memo fn get(s):\n        ret 1\n",
+    ],
+)
+def test_reject_effects_a_cached_call_would_skip(source: str) -> None:
+    with pytest.raises(SemanticError, match="memo fn"):
+        analyze(parse_source(source))
+
+
+def test_boac_keeps_the_memo_flag() -> None:
+    code = compile_source("memo fn f(x):\n    ret x\nfn g(x):\n    ret x\n")
+    loaded = boac.loads(boac.dumps(code))
+    flags = {c.name: c.memo for c in loaded.constants if isinstance(c, type(code))}
+    assert flags == {"f": True, "g": False}
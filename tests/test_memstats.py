@@ -0,0 +1,70 @@
+"""Tests for frame pooling and `run --mem-stats`."""
+
+from __future__ import annotations
+
+from io import StringIO
+from pathlib import Path
+import sys
+
+import pytest
+
+from boa.cli import main
+from boa.compiler import run_source
+from boa.memstats import POOL_SIZE, STATS
+from boa.runtime import RuntimeErrorBoa
+
+DEPTH = (
+    "fn depth(n):\n"
+    "    if n == 0:\n"
+    "        ret 0\n"
+    "    ret 1 + depth(n - 1)\n"
+)
+
+
+def _output(source: str, engine: str) -> list[str]:
+    old = sys.stdout
+    sys.stdout = buf = StringIO()
+    try:
+        run_source(source, engine)
+    finally:
+        sys.stdout = old
+    return buf.getvalue().splitlines()
+
+
+@pytest.mark.parametrize("engine", ["vm", "tree"])
+def test_finished_frames_are_reused(engine: str) -> None:
+    run_source(DEPTH + "out depth(10)\n", engine)
+    STATS.reset()
+    assert _output(DEPTH + "out depth(10)\nout depth(1000)\nout depth(1000)\n", engine) == ["10", "1000", "1000"]
+    assert STATS.peak_frames == 1001
+    # Only the frames beyond what the pool holds are allocated again.
+    assert STATS.frames < 1001 + (1001 - POOL_SIZE) + 10
+
+
+@pytest.mark.parametrize("engine", ["vm", "tree"])
+def test_a_reused_frame_starts_empty(engine: str) -> None:
+    closures = (
+        "fn make(n):\n"
+        "    fn get():\n"
+        "        ret n\n"
+        "    ret get\n"
+        "a = make(1)\n"
+        "b = make(2)\n"
+        "out a() + b()\n"
+    )
+    assert _output(closures, engine) == ["3"]
+    stale = "fn f(first):\n    if first:\n        x = 5\n    ret x\nout f(yes)\nout f(no)\n"
+    with pytest.raises(RuntimeErrorBoa, match="Unknown symbol 'x'"):
+        _output(stale, engine)
+
+
+def test_mem_stats_reports_to_stderr(tmp_path: Path, capsys: pytest.CaptureFixture[str]) -> None:
+    src = tmp_path / "main.boa"
+    src.write_text("cls Box:\n    ..\nboxes = [Box(), Box()]\n" + DEPTH + "out depth(20)\n", encoding="utf-8")
+    assert main(["run", "--mem-stats", "--no-cache", str(src)]) == 0
+    captured = capsys.readouterr()
+    assert captured.out == "20\n"
+    assert "peak call depth" in captured.err
+    assert "21 frames" in captured.err
+    assert "instances allocated" in captured.err
+    assert "peak traced memory" in captured.err
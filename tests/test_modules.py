@@ -0,0 +1,71 @@
+"""Tests for `use` module resolution and loading."""
+
+from __future__ import annotations
+
+from pathlib import Path
+
+import pytest
+
+from boa import modules
+from boa.compiler import run_file
+from boa.runtime import RuntimeErrorBoa
+
+
+def _write(path: Path, text: str) -> Path:
+    path.parent.mkdir(parents=True, exist_ok=True)
+    path.write_text(text, encoding="utf-8")
+    return path
+
+
+@pytest.mark.parametrize("engine", ["vm", "tree"])
+def test_use_loads_modules_lazily_from_search_path(
+    engine: str, tmp_path: Path, monkeypatch: pytest.MonkeyPatch, capsys: pytest.CaptureFixture[str]
+) -> None:
+    monkeypatch.setenv("BOA_PATH", str(tmp_path / "lib"))
+    _write(
+        tmp_path / "util.boa",
+        "use shapes: Box\nout \"util loaded\"\nSCALE = 10\n"
+        "fn scale(x: i) -> i:\n    ret x * SCALE\n"
+        "fn boxed(n: i):\n    ret Box(n)\n",
+    )
+    _write(tmp_path / "lib" / "shapes.boa", "cls Box:\n    fn __init__(s, n: i):\n        s.n = n\n")
+    # Never accessed, so its syntax error never surfaces.
+    _write(tmp_path / "broken.boa", "fn (:\n")
+    main = _write(
+        tmp_path / "main.boa",
+        "use util\nuse broken\nuse missing\nuse util: scale\n"
+        "out \"start\"\nout util.scale(4)\nout scale(5)\nout util.boxed(3).n\n",
+    )
+    run_file(main, engine)
+    assert capsys.readouterr().out.split() == ["util", "loaded", "start", "40", "50", "3"]
+
+
+@pytest.mark.parametrize("engine", ["vm", "tree"])
+def test_use_reports_missing_modules_and_allows_cycles(
+    engine: str, tmp_path: Path, capsys: pytest.CaptureFixture[str]
+) -> None:
+    _write(tmp_path / "ping.boa", "use pong\nNAME = \"ping\"\nfn other():\n    ret pong.NAME\n")
+    _write(tmp_path / "pong.boa", "use ping\nNAME = \"pong\"\nfn back():\n    ret ping.NAME\n")
+    main = _write(tmp_path / "main.boa", "use ping\nuse pong\nout ping.other() + pong.back()\n")
+    run_file(main, engine)
+    assert capsys.readouterr().out == "pongping\n"
+    lost = _write(tmp_path / "lost.boa", "use nowhere\nout nowhere.x\n")
+    with pytest.raises(RuntimeErrorBoa, match="Unknown module 'nowhere'"):
+        run_file(lost, engine)
+
+
+def test_compiled_modules_are_reused(tmp_path: Path, monkeypatch: pytest.MonkeyPatch) -> None:
+    monkeypatch.setenv("BOA_CACHE_DIR", str(tmp_path / "cache"))
+    _write(tmp_path / "lib.boa", "fn two() -> i:\n    ret 2\n")
+    main = _write(tmp_path / "main.boa", "use lib\nout lib.two()\n")
+    run_file(main)
+    # `main` and `lib`, each stored once in the disk cache.
+    assert len(list((tmp_path / "cache").glob("*.boac"))) == 2
+
+    def fail_parse(_source: str) -> None:
+        raise AssertionError("a compiled module should not be parsed again")
+
+    monkeypatch.setattr("boa.modules.parse_source", fail_parse)
+    run_file(main)
+    modules._compiled.clear()
+    run_file(main)
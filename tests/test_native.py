@@ -0,0 +1,98 @@
+"""Tests for the `build --native` C++ backend."""
+
+from __future__ import annotations
+
+import os
+from pathlib import Path
+import shutil
+
+import pytest
+
+from boa import native
+from boa.cli import main
+from boa.compiler import run_file
+from boa.parser import parse_source
+
+PROGRAM = """fn fib(n: i) -> i:
+    if n < 2:
+        ret n
+    ret fib(n - 1) + fib(n - 2)
+
+fn fact(n: i) -> i:
+    acc = 1
+    for k ~ range(2, n + 1):
+        acc = acc * k
+    ret acc
+
+fn mean(xs: [f]) -> f:
+    total = 0.0
+    for x ~ xs:
+        total = total + x
+    ret total / len(xs)
+
+fn halve(n: i) -> i:
+    n = n / 2
+    ret n
+
+fn greet(name: s) -> s:
+    ret "hi " + name
+
+fn twice(n: i) -> i:
+    ret n + n
+
+fn loud(n: i) -> i:
+    out n
+    ret twice(n)
+
+out fib(20)
+out fact(25)
+out mean([1.5, 2.5, 4.0])
+out twice("ab")
+out greet("boa")
+out loud(-7 % 3)
+"""
+
+_HAS_CXX = bool(os.environ.get("CXX") or shutil.which("c++") or shutil.which("g++") or shutil.which("clang++"))
+
+
+def test_lower_keeps_untyped_and_impure_functions_on_the_vm() -> None:
+    unit = native.lower(parse_source(PROGRAM))
+    assert [sig.name for sig in unit.functions] == ["fib", "fact", "mean", "twice"]
+    assert set(unit.skipped) == {"halve", "greet", "loud"}
+    # `/` makes a float, so `n` would change type.
+    assert "assigned both i and f" in unit.skipped["halve"]
+    assert "OutStmt" in unit.skipped["loud"]
+
+
+@pytest.mark.skipif(not _HAS_CXX, reason="needs a C++ compiler")
+def test_native_build_runs_like_the_vm(
+    tmp_path: Path, monkeypatch: pytest.MonkeyPatch, capsys: pytest.CaptureFixture[str]
+) -> None:
+    monkeypatch.setenv("BOA_CACHE_DIR", str(tmp_path / "cache"))
+    source = tmp_path / "app.boa"
+    source.write_text(PROGRAM, encoding="utf-8")
+    artifact = tmp_path / "app.boac"
+    run_file(source)
+    expected = capsys.readouterr().out
+    assert main(["build", "--native", str(source), str(artifact)]) == 0
+    assert native.library_path(artifact).is_file()
+    capsys.readouterr()
+    run_file(artifact)
+    # fact(25) overflows int64 and `twice("ab")` is not an int: both rerun on the VM.
+    assert capsys.readouterr().out == expected
+    assert expected.split("\n")[1] == "15511210043330985984000000"
+    assert main(["build", "--native", str(source), str(artifact)]) == 0
+    assert capsys.readouterr().out.strip() == f"Up to date: {artifact}"
+
+
+@pytest.mark.skipif(not _HAS_CXX, reason="needs a C++ compiler")
+def test_stale_native_library_is_rejected(tmp_path: Path, monkeypatch: pytest.MonkeyPatch) -> None:
+    monkeypatch.setenv("BOA_CACHE_DIR", str(tmp_path / "cache"))
+    source = tmp_path / "app.boa"
+    source.write_text("fn sq(n: i) -> i:\n    ret n * n\nout sq(3)\n", encoding="utf-8")
+    artifact = tmp_path / "app.boac"
+    assert main(["build", "--native", str(source), str(artifact)]) == 0
+    source.write_text("fn sq(n: i) -> i:\n    ret n * n * n\nout sq(3)\n", encoding="utf-8")
+    assert main(["build", str(source), str(artifact)]) == 0
+    with pytest.raises(native.NativeError, match="rebuild it with `boa build --native`"):
+        run_file(artifact)
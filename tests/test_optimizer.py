@@ -0,0 +1,126 @@
+"""Tests for the AST optimization pass."""
+
+from __future__ import annotations
+
+from io import StringIO
+from pathlib import Path
+import sys
+
+import pytest
+
+from boa import boac
+from boa.ast_nodes import BinaryExpr, BoolExpr, IfStmt, NumberExpr, OutStmt, StringExpr, UnaryExpr
+from boa.cli import main
+from boa.compiler import compile_source, run_source
+from boa.optimizer import optimize
+from boa.parser import parse_source
+
+
+def _optimized(source: str, level: int = 1) -> list:
+    return optimize(parse_source(source), level).statements
+
+
+def _capture_output(source: str, engine: str, level: int) -> str:
+    old = sys.stdout
+    buf = StringIO()
+    sys.stdout = buf
+    try:
+        run_source(source, engine, level)
+    finally:
+        sys.stdout = old
+    return buf.getvalue()
+
+
+def test_folds_literal_operands() -> None:
+    stmts = _optimized('a = 2 * 60 * 60\nb = "ab" + "c"\nc = -(3 - 5)\nd = 1 < 2\ne = f"n={a} {1 + 1}"\n')
+    assert [s.value for s in stmts[:4]] == [NumberExpr(7200), StringExpr("abc"), NumberExpr(2), BoolExpr(True)]
+    assert stmts[4].value.parts == ["n=", stmts[4].value.parts[1], " 2"]
+
+
+def test_leaves_failing_operations_for_run_time() -> None:
+    stmts = _optimized('a = 1 / 0\nb = "a" + 1\n')
+    assert isinstance(stmts[0].value, BinaryExpr)
+    assert isinstance(stmts[1].value, BinaryExpr)
+
+
+def test_skips_folds_whose_result_would_be_too_big() -> None:
+    big = str(1 << 3000)
+    source = (
+        'a = "ab" * 1000000000\n'
+        'b = 1000000000 * "ab"\n'
+        f"c = {big} * {big}\n"
+        'd = "%999999999d" % 1\n'
+        f'e = "{"x" * 3000}" + "{"y" * 3000}"\n'
+        'f = "ab" * 3\n'
+    )
+    stmts = _optimized(source)
+    assert all(isinstance(s.value, BinaryExpr) for s in stmts[:5])
+    assert stmts[5].value == StringExpr("ababab")
+
+
+def test_short_circuit_with_literal_left_operand() -> None:
+    stmts = _optimized("a = no && f()\nb = yes || f()\nc = yes && x\nd = no || 0\n")
+    assert stmts[0].value == BoolExpr(False)
+    assert stmts[1].value == BoolExpr(True)
+    assert stmts[2].value == UnaryExpr("!", UnaryExpr("!", parse_source("x\n").statements[0].expr))
+    assert stmts[3].value == BoolExpr(False)
+
+
+def test_removes_dead_branches() -> None:
+    stmts = _optimized(
+        "if no:\n    out 1\nef x:\n    out 2\nef yes:\n    out 3\nelse:\n    out 4\n"
+        "if 0:\n    out 5\nelse:\n    out 6\n"
+    )
+    first, second = stmts
+    assert isinstance(first, IfStmt) and not first.elif_blocks
+    assert first.else_body == [OutStmt(NumberExpr(3))]
+    assert second == OutStmt(NumberExpr(6))
+    assert second.line == 12
+
+
+def test_level_two_prunes_unreachable_statements() -> None:
+    src = "fn f() -> i:\n    ret 1\n    out 2\n3\nfor x ~ []:\n    out x\n"
+    assert len(_optimized(src, 1)[0].body) == 2
+    assert len(_optimized(src, 1)) == 3
+    stmts = _optimized(src, 2)
+    assert len(stmts) == 1 and len(stmts[0].body) == 1
+
+
+def test_drops_false_while_and_code_after_loop_jumps() -> None:
+    src = "while no:\n    out 1\nwhile x:\n    break\n    out 2\nfor y ~ z:\n    continue\n    out 3\n"
+    assert len(_optimized(src, 1)) == 2
+    assert [len(loop.body) for loop in _optimized(src, 1)] == [2, 2]
+    assert [len(loop.body) for loop in _optimized(src, 2)] == [1, 1]
+
+
+@pytest.mark.parametrize("engine, level", [(e, level) for e in ("vm", "tree") for level in (0, 1, 2)])
+def test_levels_preserve_behavior(engine: str, level: int) -> None:
+    src = (
+        "DAY = 24 * 60 * 60\n"
+        "if no:\n    out \"dead\"\nef 1 < 2:\n    out f\"day={DAY} {2 * 3}\"\n"
+        "fn f(x: i) -> b:\n    ret yes && x > 2\n    out \"unreachable\"\n"
+        "out f(3)\nout no || 0\n"
+    )
+    assert _capture_output(src, engine, level).splitlines() == ["day=86400 6", "True", "False"]
+
+
+@pytest.mark.parametrize("engine, level", [(e, level) for e in ("vm", "tree") for level in (0, 1, 2)])
+def test_negative_zero_keeps_its_sign(engine: str, level: int) -> None:
+    src = "a = 0.0\nb = -0.0\nout a\nout b\nout -(0.0)\n"
+    assert _capture_output(src, engine, level).splitlines() == ["0.0", "-0.0", "-0.0"]
+    if level:
+        # Folding turns `-0.0` into a literal that must not reuse the `0.0` entry.
+        code = boac.loads(boac.dumps(compile_source(src, level)))
+        assert sorted(str(c) for c in code.constants if isinstance(c, float)) == ["-0.0", "0.0"]
+
+
+def test_build_records_level_in_boac(tmp_path: Path) -> None:
+    src = tmp_path / "app.boa"
+    src.write_text("out 2 * 21\n", encoding="utf-8")
+    out = tmp_path / "app.boac"
+    assert main(["build", str(src), str(out), "-O2"]) == 0
+    data = out.read_bytes()
+    assert boac.opt_level(data) == 2
+    assert 42 in boac.loads(data).constants
+    assert main(["build", str(src), str(out), "-O0"]) == 0
+    assert 42 not in boac.loads(out.read_bytes()).constants
@@ -0,0 +1,111 @@
+"""Tests for the buffered `out` stream."""
+
+from __future__ import annotations
+
+from io import StringIO
+from pathlib import Path
+import sys
+
+import pytest
+
+from boa.compiler import run_file, run_source
+from boa.output import OutputBuffer
+from boa.runtime import RuntimeErrorBoa
+
+
+class _Writes(StringIO):
+    """A stdout that records each `write` call."""
+
+    def __init__(self) -> None:
+        super().__init__()
+        self.calls: list[str] = []
+
+    def write(self, text: str) -> int:
+        self.calls.append(text)
+        return super().write(text)
+
+
+def _run(source: str, engine: str, **options: int) -> _Writes:
+    old = sys.stdout
+    sys.stdout = stream = _Writes()
+    try:
+        run_source(source, engine, **options)
+    finally:
+        sys.stdout = old
+    return stream
+
+
+LOOP = "i = 0\nwhile i < 500:\n    out i\n    i = i + 1\n"
+LINES = "".join(f"{i}\n" for i in range(500))
+
+
+def test_lines_are_written_once_they_exceed_the_limit() -> None:
+    old = sys.stdout
+    sys.stdout = stream = _Writes()
+    try:
+        buffer = OutputBuffer(limit=10)
+        buffer.line("abc")
+        buffer.line(True)
+        assert stream.calls == []
+        buffer.line(1.5)
+        assert stream.calls == ["abc\nTrue\n1.5\n"]
+        buffer.line([1, 2])
+        buffer.flush()
+    finally:
+        sys.stdout = old
+    assert stream.calls == ["abc\nTrue\n1.5\n", "[1, 2]\n"]
+
+
+@pytest.mark.parametrize("engine", ["vm", "tree"])
+def test_out_in_a_loop_is_batched_unless_unbuffered(engine: str) -> None:
+    batched = _run(LOOP, engine)
+    assert batched.getvalue() == LINES
+    assert len(batched.calls) == 1
+    unbuffered = _run(LOOP, engine, out_buffer=0)
+    assert unbuffered.getvalue() == LINES
+    assert len(unbuffered.calls) == 500
+
+
+@pytest.mark.parametrize("engine", ["vm", "tree"])
+def test_loading_a_module_keeps_the_run_unbuffered(engine: str, tmp_path: Path) -> None:
+    (tmp_path / "util.boa").write_text('fn hi():\n    out "hi"\n', encoding="utf-8")
+    main = tmp_path / "main.boa"
+    main.write_text('use util\nout "before"\nutil.hi()\nfor i ~ range(3):\n    out i\n', encoding="utf-8")
+    old = sys.stdout
+    sys.stdout = stream = _Writes()
+    try:
+        run_file(main, engine, use_cache=False, out_buffer=0)
+    finally:
+        sys.stdout = old
+    assert stream.calls == ["before\n", "hi\n", "0\n", "1\n", "2\n"]
+
+
+@pytest.mark.parametrize("engine", ["vm", "tree"])
+def test_output_before_an_error_is_flushed(engine: str) -> None:
+    old = sys.stdout
+    sys.stdout = stream = StringIO()
+    try:
+        with pytest.raises(RuntimeErrorBoa, match="Unknown symbol 'nope'"):
+            run_source("out 1\nout 2\nout nope\n", engine)
+    finally:
+        sys.stdout = old
+    assert stream.getvalue() == "1\n2\n"
+
+
+def test_ask_flushes_before_prompting(monkeypatch: pytest.MonkeyPatch) -> None:
+    seen: list[str] = []
+    stream = StringIO()
+
+    def fake_input(prompt: str = "") -> str:
+        seen.append(stream.getvalue())
+        return "Ada"
+
+    monkeypatch.setattr("builtins.input", fake_input)
+    old = sys.stdout
+    sys.stdout = stream
+    try:
+        run_source('out "hello"\nname = ask("name? ")\nout name\n')
+    finally:
+        sys.stdout = old
+    assert seen == ["hello\n"]
+    assert stream.getvalue() == "hello\nAda\n"
@@ -0,0 +1,82 @@
+"""Tests for `pfor` and `par()`."""
+
+from __future__ import annotations
+
+from io import StringIO
+import multiprocessing
+import sys
+
+import pytest
+
+from boa import parallel
+from boa.compiler import run_source
+from boa.runtime import RuntimeErrorBoa
+
+PROGRAM = """fn work(n: i) -> i:
+    t = 0
+    for k ~ range(n):
+        t = t + k % 7
+    ret t
+
+scale = 3
+pfor x ~ range(150):
+    y = work(x) * scale
+    if x % 40 != 0:
+        continue
+    out f"{x}: {y}"
+out par(work, [10, 20, 30])
+out par(work, range(200), "+")
+out par(work, range(200), "max")
+fn twice(xs: [i]):
+    pfor v ~ xs:
+        out v * 2
+twice([1, 2, 3])
+"""
+
+EXPECTED = ["0: 0", "40: 345", "80: 702", "120: 1071", "[24, 57, 85]", "58902", "591", "2", "4", "6"]
+
+needs_fork = pytest.mark.skipif(
+    "fork" not in multiprocessing.get_all_start_methods(), reason="workers are forked"
+)
+
+
+def _output(engine: str) -> list[str]:
+    old = sys.stdout
+    sys.stdout = buf = StringIO()
+    try:
+        run_source(PROGRAM, engine)
+    finally:
+        sys.stdout = old
+    return buf.getvalue().splitlines()
+
+
+def test_chunks_depend_on_the_item_count_alone() -> None:
+    assert parallel.chunks(0) == []
+    assert parallel.chunks(3) == [(0, 1), (1, 2), (2, 3)]
+    bounds = parallel.chunks(1000)
+    assert len(bounds) <= parallel.MAX_CHUNKS
+    assert bounds[0] == (0, 16) and bounds[-1][1] == 1000
+
+
+@needs_fork
+@pytest.mark.parametrize("engine", ["vm", "tree"])
+def test_pfor_and_par_on_workers_match_a_sequential_run(engine: str, monkeypatch: pytest.MonkeyPatch) -> None:
+    monkeypatch.setenv("BOA_JOBS", "1")
+    assert _output(engine) == EXPECTED
+    monkeypatch.setenv("BOA_JOBS", "3")
+    assert _output(engine) == EXPECTED
+
+
+@needs_fork
+def test_worker_errors_surface_after_earlier_output(monkeypatch: pytest.MonkeyPatch) -> None:
+    monkeypatch.setenv("BOA_JOBS", "2")
+    old = sys.stdout
+    sys.stdout = buf = StringIO()
+    try:
+        with pytest.raises(RuntimeErrorBoa, match="Unknown symbol 'nope'"):
+            run_source("pfor x ~ range(10):\n    if x == 6:\n        out nope\n    out x\n")
+    finally:
+        sys.stdout = old
+    assert buf.getvalue().split() == ["0", "1", "2", "3", "4", "5"]
+    with pytest.raises(RuntimeErrorBoa, match="reduction of an empty list"):
+        run_source("fn f(x):\n    ret x\nout par(f, [], \"min\")\n")
@@ -1,6 +1,21 @@
 """Tests for Boa parser."""
 
-from boa.ast_nodes import FunctionDef, Program
+import pytest
+
+from boa.ast_nodes import (
+    AttrExpr,
+    AwaitExpr,
+    BinaryExpr,
+    BreakStmt,
+    ContinueStmt,
+    FStringExpr,
+    FunctionDef,
+    OutStmt,
+    PassStmt,
+    Program,
+    StringExpr,
+    WhileStmt,
+)
 from boa.parser import parse_source
 
 
@@ -14,3 +29,61 @@ def test_parse_function_definition() -> None:
 def test_parse_assignment_and_out() -> None:
     unit = parse_source("x: i = 1\nout x\n")
     assert len(unit.statements) == 2
+
+
+def test_parse_fstring_into_segments() -> None:
+    unit = parse_source('out f"{s.name} says {{hi}}"\n')
+    stmt = unit.statements[0]
+    assert isinstance(stmt, OutStmt)
+    assert isinstance(stmt.expr, FStringExpr)
+    field, text = stmt.expr.parts
+    assert isinstance(field, AttrExpr) and field.name == "name"
+    assert text == " says {hi}"
+
+
+def test_parse_fstring_without_fields_is_plain_string() -> None:
+    unit = parse_source('out f"no fields"\n')
+    assert unit.statements[0].expr == StringExpr("no fields")
+
+
+def test_plain_strings_starting_with_f_are_not_fstrings() -> None:
+    unit = parse_source('out "foo"\nout "f{x}"\nout \'fx{1}\'\nout f"f{1}"\n')
+    plain, braces, single, fstring = (stmt.expr for stmt in unit.statements)
+    assert [plain, braces, single] == [StringExpr("foo"), StringExpr("f{x}"), StringExpr("fx{1}")]
+    assert isinstance(fstring, FStringExpr) and fstring.parts[0] == "f"
+
+
+def test_parse_fstring_rejects_unterminated_field() -> None:
+    with pytest.raises(ValueError):
+        parse_source('out f"{name"\n')
+
+
+def test_parse_while_with_break_continue_and_pass() -> None:
+    program = parse_source("while x < 3:\n    if x:\n        continue\n    break\n    ..\n")
+    loop = program.statements[0]
+    assert isinstance(loop, WhileStmt)
+    assert isinstance(loop.body[0].body[0], ContinueStmt)
+    assert isinstance(loop.body[1], BreakStmt)
+    assert loop.body[2] == PassStmt()
+    assert loop.body[1].line == 4
+
+
+def test_parse_afn_and_aw() -> None:
+    program = parse_source("afn fetch(url: s) -> s:\n    data = aw get(url)\n    ret data\nfn f():\n    ..\n")
+    fetch, plain = program.statements
+    assert fetch.is_async and not plain.is_async
+    assert isinstance(fetch.body[0].value, AwaitExpr)
+    assert fetch.body[0].value.expr.func.name == "get"
+
+
+def test_nodes_carry_positions_without_instance_dicts() -> None:
+    (stmt,) = parse_source('out 1 + f"{a.b}"(2)\n').statements
+    expr = stmt.expr
+    assert isinstance(expr, BinaryExpr)
+    assert (stmt.line, stmt.column, expr.column, expr.right.column) == (1, 1, 7, 17)
+    # f-string fields keep their place in the file, not in the field text.
+    attr = expr.right.func.parts[0]
+    assert isinstance(attr, AttrExpr) and (attr.line, attr.column) == (1, 14)
+    assert not hasattr(expr, "__dict__") and not hasattr(stmt, "__dict__")
+    # Positions take no part in equality.
+    assert parse_source("out 1 + 2\n") == parse_source("\n\nout 1  +  2\n")
@@ -0,0 +1,80 @@
+"""Tests for the run profiler."""
+
+from __future__ import annotations
+
+from pathlib import Path
+
+import pytest
+
+from boa.bytecode import PROFILE_ENTER, PROFILE_LINE, compile_program
+from boa.cli import main
+from boa.parser import parse_source
+from boa.profiler import Profiler, profile_source
+
+FIB = (
+    "fn fib(n: i) -> i:\n"
+    "    if n < 2:\n"
+    "        ret n\n"
+    "    ret fib(n - 1) + fib(n - 2)\n"
+    "out fib(6)\n"
+)
+
+
+class _Clock:
+    def __init__(self) -> None:
+        self.now = 0.0
+
+    def __call__(self) -> float:
+        return self.now
+
+
+def test_profile_builds_only_instrument_on_request() -> None:
+    program = parse_source(FIB)
+    plain = {op for op, _ in compile_program(program).instructions}
+    profiled = compile_program(program, profile=True).instructions
+    assert PROFILE_LINE not in plain
+    assert profiled[0] == (PROFILE_ENTER, 0)
+    assert (PROFILE_LINE, 5) in profiled
+
+
+@pytest.mark.parametrize("engine", ["vm", "tree"])
+def test_profile_counts_calls_and_lines(engine: str, capsys: pytest.CaptureFixture[str]) -> None:
+    profiler = profile_source(FIB, engine)
+    assert capsys.readouterr().out == "8\n"
+    assert profiler.functions["fib"].calls == 25
+    assert profiler.functions["<module>"].calls == 1
+    assert profiler.lines[2] == 25
+    assert profiler.lines[3] == 13
+    assert "execute" in profiler.phases
+
+
+def test_recursive_inclusive_time_counts_outermost_call_once() -> None:
+    clock = _Clock()
+    profiler = Profiler(clock)
+    profiler.enter("main")
+    clock.now = 1.0
+    profiler.enter("f")
+    clock.now = 2.0
+    profiler.enter("f")
+    clock.now = 5.0
+    profiler.exit()
+    clock.now = 6.0
+    profiler.exit()
+    clock.now = 10.0
+    profiler.exit()
+
+    f = profiler.functions["f"]
+    assert (f.calls, f.inclusive, f.exclusive) == (2, 5.0, 5.0)
+    assert profiler.functions["main"].exclusive == 5.0
+    assert profiler.collapsed() == "main 5000000\nmain;f 2000000\nmain;f;f 3000000\n"
+
+
+def test_cli_profile_writes_report_and_stacks(tmp_path: Path, capsys: pytest.CaptureFixture[str]) -> None:
+    src = tmp_path / "fib.boa"
+    src.write_text(FIB, encoding="utf-8")
+    assert main(["run", str(src), "--profile"]) == 0
+    captured = capsys.readouterr()
+    assert captured.out == "8\n"
+    assert "fib" in captured.err
+    stacks = (tmp_path / "fib.collapsed").read_text(encoding="utf-8").splitlines()
+    assert any(line.startswith("<module>;fib;fib ") for line in stacks)
@@ -37,6 +37,12 @@ def test_fstring_interpolation() -> None:
     assert out.strip() == "Hello, Boa!"
 
 
+def test_fstring_expression_fields() -> None:
+    src = "nums = [1, 2, 3]\nfor x ~ nums:\n    out f\"{x}/{len(nums)}={x * 10}%\"\n"
+    out = _capture_output(src)
+    assert out.split() == ["1/3=10%", "2/3=20%", "3/3=30%"]
+
+
 def test_run_hello_sample(monkeypatch) -> None:
     sample = Path(__file__).resolve().parent / "samples" / "hello.boa"
     monkeypatch.setattr("builtins.input", lambda _prompt="": "Boa")
@@ -0,0 +1,86 @@
+"""Tests for static scope resolution."""
+
+from __future__ import annotations
+
+from io import StringIO
+import sys
+
+from boa.bytecode import LOAD_DEREF, LOAD_FAST, CodeObject, compile_program
+from boa.compiler import run_source
+from boa.parser import parse_source
+from boa.scopes import DEREF, FAST, GLOBAL, instance_layout, resolve_scopes
+
+
+def _capture_output(source: str) -> str:
+    old = sys.stdout
+    buf = StringIO()
+    sys.stdout = buf
+    try:
+        run_source(source)
+    finally:
+        sys.stdout = old
+    return buf.getvalue()
+
+
+def test_params_come_first_then_block_locals() -> None:
+    program = parse_source(
+        "fn f(a: i, b: i) -> i:\n"
+        "    for x ~ [1]:\n"
+        "        y = x\n"
+        "    if a:\n"
+        "        z = 1\n"
+        "    ret a\n"
+    )
+    scope = resolve_scopes(program)[id(program.statements[0])]
+    assert scope.varnames == ["a", "b", "x", "y", "z"]
+    assert scope.lookup("y") == (FAST, 0, 3)
+    assert scope.lookup("len") == (GLOBAL, 0, 0)
+
+
+def test_nested_function_reads_enclosing_slot() -> None:
+    src = (
+        "fn outer() -> i:\n"
+        "    base = 10\n"
+        "    fn inner(n: i) -> i:\n"
+        "        ret base + n\n"
+        "    ret inner(5)\n"
+        "out outer()\n"
+    )
+    program = parse_source(src)
+    outer = program.statements[0]
+    inner_scope = resolve_scopes(program)[id(outer.body[1])]
+    assert inner_scope.lookup("base") == (DEREF, 1, 0)
+
+    module = compile_program(program)
+    outer_code = next(c for c in module.constants if isinstance(c, CodeObject))
+    inner_code = next(c for c in outer_code.constants if isinstance(c, CodeObject))
+    ops = {op for op, _ in inner_code.instructions}
+    assert {LOAD_DEREF, LOAD_FAST} <= ops
+    assert _capture_output(src).strip() == "15"
+
+
+def test_unassigned_local_falls_back_to_module_scope() -> None:
+    src = (
+        "x = 1\n"
+        "fn f():\n"
+        "    out x\n"
+        "    x = 2\n"
+        "    out x\n"
+        "f()\n"
+    )
+    assert _capture_output(src).split() == ["1", "2"]
+
+
+def test_instance_layout_follows_init_assignments() -> None:
+    program = parse_source(
+        "cls Node:\n"
+        "    fn __init__(this, v: i):\n"
+        "        this.value = v\n"
+        "        if v > 0:\n"
+        "            this.left = nil\n"
+        "            this.value = v\n"
+        "        other = Node\n"
+        "    fn grow(this):\n"
+        "        this.right = nil\n"
+    )
+    assert instance_layout(program.statements[0]) == ["value", "left"]
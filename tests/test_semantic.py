@@ -18,6 +18,55 @@ def test_reject_bad_type_annotation() -> None:
         analyze(unit)
 
 
+@pytest.mark.parametrize(
+    "source",
+    ["break\n", "if yes:\n    continue\n", "for x ~ [1]:\n    fn f():\n        break\n"],
+)
+def test_reject_loop_control_outside_loop(source: str) -> None:
+    with pytest.raises(SemanticError):
+        analyze(parse_source(source))
+
+
+@pytest.mark.parametrize(
+    "source",
+    [
+        "fn f():\n    x = aw g()\n",
+        "aw g()\n",
+        "afn f():\n    out 1 + (aw g())\n",
+        "afn f():\n    if aw g():\n        ..\n",
+        "cls C:\n    afn __init__(s):\n        ..\n",
+    ],
+)
+def test_reject_misplaced_await(source: str) -> None:
+    with pytest.raises(SemanticError):
+        analyze(parse_source(source))
+
+
+@pytest.mark.parametrize(
+    "source",
+    [
+        "t = 0\npfor x ~ [1]:\n    t = t + x\n",
+        "pfor x ~ [1]:\n    y = x\nout y\n",
+        "fn f(o):\n    pfor x ~ [1]:\n        o.v = x\n",
+        "fn f(xs):\n    pfor x ~ xs:\n        ret x\n",
+        "pfor x ~ [1]:\n    break\n",
+        "for x ~ [1]:\n    pfor y ~ [2]:\n        break\n",
+    ],
+)
+def test_reject_pfor_body_with_shared_effects(source: str) -> None:
+    with pytest.raises(SemanticError):
+        analyze(parse_source(source))
+
+
+def test_accept_pfor_with_private_bindings() -> None:
+    source = (
+        "k = 2\n"
+        "pfor x ~ [1, 2]:\n    y = x * k\n    for z ~ [y]:\n        break\n    out y\n"
+        "pfor x ~ [3]:\n    y = x\n"
+    )
+    analyze(parse_source(source))
+
+
 def test_accept_valid_program() -> None:
     unit = parse_source("fn a(x: i) -> i:\n    ret x\n")
     analyze(unit)
@@ -0,0 +1,91 @@
+"""Tests for `boa serve` and forwarding `boa run` to it."""
+
+from __future__ import annotations
+
+from contextlib import contextmanager
+import os
+from pathlib import Path
+import signal
+import subprocess
+import sys
+import time
+from typing import Iterator
+
+import pytest
+
+from boa import serve
+
+CLI = Path(__file__).resolve().parents[1] / "src" / "boa" / "cli.py"
+
+needs_server = pytest.mark.skipif(not serve.available(), reason="needs Unix sockets and fork")
+
+PROGRAM = 'out "hello"\nname = ask("who? ")\nout f"hi {name}"\nout nope\n'
+
+
+@contextmanager
+def _server(socket_path: Path) -> Iterator[None]:
+    process = subprocess.Popen(
+        [sys.executable, str(CLI), "serve", "--socket", str(socket_path)], stderr=subprocess.DEVNULL
+    )
+    try:
+        deadline = time.monotonic() + 20
+        while serve._connect(str(socket_path)) is None:
+            assert process.poll() is None and time.monotonic() < deadline, "server did not start"
+            time.sleep(0.05)
+        yield
+    finally:
+        process.terminate()
+        process.wait(timeout=10)
+    assert not socket_path.exists()
+
+
+def _run(cwd: Path, *args: str, server: Path | None = None, stdin: str = "") -> subprocess.CompletedProcess[str]:
+    env = dict(os.environ)
+    env.pop("BOA_SERVER", None)
+    if server is not None:
+        env["BOA_SERVER"] = str(server)
+    return subprocess.run(
+        [sys.executable, str(CLI), "run", *args], cwd=cwd, env=env, input=stdin, capture_output=True, text=True
+    )
+
+
+@needs_server
+def test_a_served_run_behaves_like_a_local_one(tmp_path: Path) -> None:
+    (tmp_path / "main.boa").write_text(PROGRAM, encoding="utf-8")
+    socket_path = tmp_path / "boa.sock"
+    local = _run(tmp_path, "main.boa", stdin="Ada\n")
+    assert local.returncode == 1
+    assert local.stdout == "hello\nwho? hi Ada\n"
+    assert "Unknown symbol 'nope' at 4:5" in local.stderr
+    with _server(socket_path):
+        for _ in range(2):
+            served = _run(tmp_path, "main.boa", server=socket_path, stdin="Ada\n")
+            assert (served.returncode, served.stdout, served.stderr) == (1, local.stdout, local.stderr)
+
+
+@needs_server
+def test_an_unreachable_server_runs_the_program_locally(tmp_path: Path) -> None:
+    (tmp_path / "main.boa").write_text('out "ok"\n', encoding="utf-8")
+    result = _run(tmp_path, "main.boa", server=tmp_path / "missing.sock")
+    assert (result.returncode, result.stdout) == (0, "ok\n")
+
+
+@needs_server
+def test_ctrl_c_interrupts_the_served_run(tmp_path: Path) -> None:
+    (tmp_path / "spin.boa").write_text('out "started"\nwhile 1 == 1:\n    ..\n', encoding="utf-8")
+    socket_path = tmp_path / "boa.sock"
+    with _server(socket_path):
+        env = dict(os.environ, BOA_SERVER=str(socket_path))
+        client = subprocess.Popen(
+            [sys.executable, str(CLI), "run", "--unbuffered", "spin.boa"],
+            cwd=tmp_path,
+            env=env,
+            stdout=subprocess.PIPE,
+            stderr=subprocess.DEVNULL,
+            text=True,
+        )
+        assert client.stdout is not None
+        assert client.stdout.readline() == "started\n"
+        client.send_signal(signal.SIGINT)
+        assert client.wait(timeout=10) == 128 + signal.SIGINT
+        client.stdout.close()
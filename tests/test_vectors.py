@@ -0,0 +1,70 @@
+"""Tests for the bulk list builtins."""
+
+from __future__ import annotations
+
+from io import StringIO
+import sys
+
+import pytest
+
+from boa.arrays import TypedArray, pack
+from boa.compiler import run_source
+from boa.runtime import RuntimeErrorBoa
+from boa.vectors import BUILTINS
+
+PROGRAM = """xs: [i] = [3, 1, 4, 1, 5]
+fs: [f] = [0.5, 1.5]
+out sum(xs)
+out min(xs)
+out max(fs)
+out min(3, 2)
+out dot(xs, xs)
+out map(xs, "*", 2)
+out map(xs, "/", 2)
+out map(fs, "-", [1.0, 1.0])
+out filter(xs, ">", 2)
+out sum(range(5))
+"""
+
+
+@pytest.mark.parametrize("engine", ["vm", "tree"])
+def test_vector_builtins_match_their_loops(engine: str) -> None:
+    old = sys.stdout
+    sys.stdout = buf = StringIO()
+    try:
+        run_source(PROGRAM, engine)
+    finally:
+        sys.stdout = old
+    assert buf.getvalue().splitlines() == [
+        "14",
+        "1",
+        "1.5",
+        "2",
+        "52",
+        "[6, 2, 8, 2, 10]",
+        "[1.5, 0.5, 2.0, 0.5, 2.5]",
+        "[-0.5, 0.5]",
+        "[3, 4, 5]",
+        "10",
+    ]
+
+
+def test_packed_inputs_give_packed_results() -> None:
+    xs = pack([1, 2, 3], "[i]")
+    doubled = BUILTINS["map"](xs, "*", 2)
+    assert type(doubled) is TypedArray and doubled.typecode == "q"
+    assert BUILTINS["map"](xs, "/", 2).typecode == "d"
+    assert type(BUILTINS["filter"](xs, "!=", 2)) is TypedArray
+    # Plain lists stay plain, and so does a result that leaves int64.
+    assert type(BUILTINS["map"]([1, 2], "+", 1)) is list
+    assert BUILTINS["map"](xs, "*", 2**62) == [2**62, 2**63, 3 * 2**62]
+    assert type(BUILTINS["map"](xs, "*", 2**62)) is list
+
+
+def test_vector_builtins_reject_bad_operands() -> None:
+    with pytest.raises(RuntimeErrorBoa, match="different lengths"):
+        BUILTINS["dot"]([1, 2], [1])
+    with pytest.raises(RuntimeErrorBoa, match="operator must be one of"):
+        BUILTINS["map"]([1], "<", 1)
+    with pytest.raises(RuntimeErrorBoa, match="empty list"):
+        BUILTINS["max"]([])
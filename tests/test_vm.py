@@ -0,0 +1,370 @@
+"""Tests for the Boa bytecode compiler and VM."""
+
+from __future__ import annotations
+
+from io import StringIO
+import sys
+
+import pytest
+
+from boa import boac
+from boa.bytecode import (
+    BINARY_OP,
+    CALL_METHOD,
+    COMPARE_JUMP,
+    FOR_ITER,
+    FOR_RANGE,
+    LOAD_METHOD,
+    POP_JUMP_IF_FALSE,
+    TAIL_CALL,
+    ClassCode,
+    compile_program,
+    disassemble,
+)
+from boa.compiler import run_source
+from boa.parser import parse_source
+from boa.runtime import BoaInstance, RuntimeErrorBoa
+from boa.vm import run_code
+
+
+def _capture_output(source: str, engine: str) -> str:
+    old = sys.stdout
+    buf = StringIO()
+    sys.stdout = buf
+    try:
+        run_source(source, engine)
+    finally:
+        sys.stdout = old
+    return buf.getvalue()
+
+
+def test_compile_for_loop_emits_iteration_opcodes() -> None:
+    code = compile_program(parse_source("for x ~ [1, 2]:\n    out x + 1\n"))
+    ops = [op for op, _ in code.instructions]
+    assert FOR_ITER in ops
+    assert BINARY_OP in ops
+    assert "FOR_ITER" in disassemble(code)
+
+
+@pytest.mark.parametrize("engine", ["vm", "tree"])
+def test_engines_agree_on_loops_and_calls(engine: str) -> None:
+    src = (
+        "fn fib(n: i) -> i:\n"
+        "    if n < 2:\n"
+        "        ret n\n"
+        "    ret fib(n - 1) + fib(n - 2)\n"
+        "total = 0\n"
+        "for x ~ range(10):\n"
+        "    if x % 2 == 0 && x != 4:\n"
+        "        total = total + x\n"
+        "out total\n"
+        "out fib(15)\n"
+        "out 3 ~ [1, 2, 3] || no\n"
+    )
+    assert _capture_output(src, engine).split() == ["16", "610", "True"]
+
+
+@pytest.mark.parametrize("engine", ["vm", "tree"])
+def test_ret_inside_loop_stops_iteration(engine: str) -> None:
+    src = (
+        "fn first_even(xs: [i]) -> i:\n"
+        "    for x ~ xs:\n"
+        "        out x\n"
+        "        if x % 2 == 0:\n"
+        "            ret x\n"
+        "    ret -1\n"
+        "out first_even([1, 3, 4, 5, 6])\n"
+        "out first_even([1])\n"
+    )
+    assert _capture_output(src, engine).split() == ["1", "3", "4", "4", "1", "-1"]
+
+
+def test_vm_deep_recursion_does_not_use_host_stack() -> None:
+    src = (
+        "fn down(n: i) -> i:\n"
+        "    if n == 0:\n"
+        "        ret 0\n"
+        "    ret 1 + down(n - 1)\n"
+        "out down(5000)\n"
+    )
+    assert _capture_output(src, "vm").strip() == "5000"
+
+
+TAIL_CALLS = (
+    "fn count(n: i, acc: i) -> i:\n"
+    "    if n == 0:\n"
+    "        ret acc\n"
+    "    ret count(n - 1, acc + 2)\n"
+    "cls Walker:\n"
+    "    fn __init__(s, steps: i):\n"
+    "        s.steps = steps\n"
+    "        ret s.walk(steps)\n"
+    "    fn walk(s, n: i) -> i:\n"
+    "        if n == 0:\n"
+    "            ret 0\n"
+    "        ret s.walk(n - 1)\n"
+    "out count(3000, 0)\n"
+    "out Walker(3000).steps\n"
+)
+
+
+@pytest.mark.parametrize("engine", ["vm", "tree"])
+def test_tail_calls_run_in_constant_depth(engine: str, capsys: pytest.CaptureFixture[str]) -> None:
+    run_source(TAIL_CALLS, engine, max_stack=20)
+    assert capsys.readouterr().out.split() == ["6000", "3000"]
+    ops = [op for op, _ in compile_program(parse_source(TAIL_CALLS)).constants[0].instructions]
+    assert TAIL_CALL in ops
+
+
+@pytest.mark.parametrize("engine", ["vm", "tree"])
+def test_max_stack_bounds_non_tail_recursion(engine: str) -> None:
+    src = "fn down(n: i) -> i:\n    if n == 0:\n        ret 0\n    ret 1 + down(n - 1)\nout down(50)\n"
+    with pytest.raises(RuntimeErrorBoa, match="--max-stack"):
+        run_source(src, engine, max_stack=40)
+
+
+@pytest.mark.parametrize("engine", ["vm", "tree"])
+def test_runtime_errors_report_source_positions(engine: str) -> None:
+    src = "fn f(p):\n    ret p.missing\nx = 1\nout x + f(2)\n"
+    with pytest.raises(RuntimeErrorBoa, match="Attribute access supported only on instances at 2:11"):
+        run_source(src, engine)
+    with pytest.raises(RuntimeErrorBoa, match="Unknown symbol 'y' at 2:9"):
+        run_source("out 1\nout 2 + y\n", engine)
+
+
+def test_run_source_rejects_unknown_engine() -> None:
+    with pytest.raises(ValueError):
+        run_source("out 1\n", "jit")
+
+
+INSTANCES = (
+    "cls Point:\n"
+    "    fn __init__(s, x: i, y: i):\n"
+    "        s.x = x\n"
+    "        s.y = y\n"
+    "    fn sum(s) -> i:\n"
+    "        ret s.x + s.y\n"
+    "    fn shift(s, d: i):\n"
+    "        s.x = s.x + d\n"
+    "        s.note = \"moved\"\n"
+    "total = 0\n"
+    "for i ~ range(4):\n"
+    "    total = total + Point(i, 1).sum()\n"
+    "p = Point(1, 2)\n"
+    "p.shift(10)\n"
+    "get = p.sum\n"
+    "out total\n"
+    "out get()\n"
+    "out p.note\n"
+)
+
+
+@pytest.mark.parametrize("engine", ["vm", "tree"])
+def test_instance_fields_and_methods(engine: str) -> None:
+    assert _capture_output(INSTANCES, engine).split() == ["10", "13", "moved"]
+
+
+def test_method_calls_use_inline_caches_and_slot_layout() -> None:
+    code = compile_program(parse_source(INSTANCES))
+    ops = [op for op, _ in code.instructions]
+    assert LOAD_METHOD in ops and CALL_METHOD in ops
+
+    old = sys.stdout
+    sys.stdout = StringIO()
+    try:
+        env = run_code(code)
+    finally:
+        sys.stdout = old
+    point = env.values["p"]
+    assert isinstance(point, BoaInstance)
+    assert point.values == [11, 2]
+    assert point.extra == {"note": "moved"}
+    assert point.fields == {"x": 11, "y": 2, "note": "moved"}
+    site = next(site for site in code.sites.values() if site[2] is not None)
+    assert site[0] is point.cls
+    shift = next(c for c in code.constants if isinstance(c, ClassCode)).methods[2]
+    assert any(site[1] == 0 for site in shift.sites.values())
+
+
+def test_conditions_fuse_compare_and_branch() -> None:
+    code = compile_program(
+        parse_source("fn f(n: i, s: s) -> s:\n    if n < 3:\n        ret f\"{s}{n}\"\n    ret s\nout f(1, \"a\")\n")
+    )
+    fn = next(c for c in code.constants if hasattr(c, "instructions"))
+    ops = [op for op, _ in fn.instructions]
+    assert COMPARE_JUMP in ops and POP_JUMP_IF_FALSE not in ops
+    assert "COMPARE_JUMP" in disassemble(fn)
+    # Untyped operands fuse too: the op applies the generic operator.
+    code = compile_program(parse_source("fn g(a, b):\n    while a ~ b:\n        ret 1\n    ret 0\n"))
+    fn = next(c for c in code.constants if hasattr(c, "instructions"))
+    ops = [op for op, _ in fn.instructions]
+    assert COMPARE_JUMP in ops and POP_JUMP_IF_FALSE not in ops
+
+
+@pytest.mark.parametrize("engine", ["vm", "tree"])
+def test_wrong_annotations_keep_generic_semantics(engine: str) -> None:
+    # Annotations are not enforced, so compiled code must still handle
+    # whatever values actually arrive.
+    src = (
+        "fn pick(a: i, b: i, label: s) -> s:\n"
+        "    if a < b:\n"
+        "        ret f\"{label}<\"\n"
+        "    ef a == b:\n"
+        "        ret f\"{label}=\"\n"
+        "    ret f\"{label}>\"\n"
+        "out pick(1, 2, 7)\n"
+        "out pick(\"b\", \"a\", yes)\n"
+        "out pick(2.5, 2.5, nil)\n"
+    )
+    assert _capture_output(src, engine).split() == ["7<", "True>", "None="]
+
+
+def test_local_range_loops_compile_to_for_range() -> None:
+    src = "fn f(n: i) -> i:\n    t = 0\n    for i ~ range(n):\n        t = t + i\n    ret t\nfor x ~ range(2):\n    out x\n"
+    code = compile_program(parse_source(src))
+    fn = next(c for c in code.constants if hasattr(c, "instructions"))
+    assert FOR_RANGE in [op for op, _ in fn.instructions]
+    assert FOR_RANGE not in [op for op, _ in code.instructions]
+    assert "FOR_RANGE" in disassemble(fn)
+
+
+def test_a_range_loop_too_long_for_for_range_uses_for_iter() -> None:
+    # Each `t = t + k` is four instructions, so the loop exits past the
+    # farthest target a FOR_RANGE arg can hold.
+    body = "        t = t + k\n" * 20000
+    src = (
+        "fn f() -> i:\n    t = 0\n    for k ~ range(2):\n"
+        "        fn g():\n            ret 1\n"
+        "        for j ~ range(3):\n            t = t + g()\n"
+        + body
+        + "    ret t\nout f()\n"
+    )
+    code = boac.loads(boac.dumps(compile_program(parse_source(src))))
+    fn = next(c for c in code.constants if hasattr(c, "instructions"))
+    ops = [op for op, _ in fn.instructions]
+    assert ops.count(FOR_ITER) == 1 and ops.count(FOR_RANGE) == 1
+    assert sum(1 for c in fn.constants if hasattr(c, "instructions")) == 1
+    old = sys.stdout
+    sys.stdout = buf = StringIO()
+    try:
+        run_code(code)
+    finally:
+        sys.stdout = old
+    assert buf.getvalue() == "20006\n"
+
+
+@pytest.mark.parametrize("engine", ["vm", "tree"])
+def test_range_is_lazy(engine: str) -> None:
+    # A materialized list of this size would not fit in memory.
+    src = (
+        "fn first_over(limit: i) -> i:\n"
+        "    for i ~ range(10, 1000000000000, 7):\n"
+        "        if i > limit:\n"
+        "            ret i\n"
+        "    ret -1\n"
+        "r = range(1000000000000)\n"
+        "out first_over(100)\n"
+        "out len(r)\n"
+        "out 999999999999 ~ r\n"
+        "total = 0\n"
+        "for k ~ range(5, 0, -2):\n"
+        "    total = total + k\n"
+        "out total\n"
+    )
+    assert _capture_output(src, engine).split() == ["101", "1000000000000", "True", "9"]
+
+
+@pytest.mark.parametrize("engine", ["vm", "tree"])
+def test_while_break_and_continue(engine: str) -> None:
+    src = (
+        "fn poll(limit: i) -> i:\n"
+        "    n = 0\n"
+        "    tries = 0\n"
+        "    while yes:\n"
+        "        tries = tries + 1\n"
+        "        if tries % 2 == 0:\n"
+        "            continue\n"
+        "        n = n + tries\n"
+        "        if n > limit:\n"
+        "            break\n"
+        "    ret n\n"
+        "fn first_even(xs) -> i:\n"
+        "    found = -1\n"
+        "    for x ~ xs:\n"
+        "        for y ~ range(3):\n"
+        "            if y == 1:\n"
+        "                break\n"
+        "        if x % 2 == 0:\n"
+        "            found = x\n"
+        "            break\n"
+        "    ret found\n"
+        "i = 0\n"
+        "while i < 3:\n"
+        "    i = i + 1\n"
+        "    ..\n"
+        "out poll(10)\n"
+        "out first_even([1, 3, 4, 6])\n"
+        "out i\n"
+    )
+    assert _capture_output(src, engine).split() == ["16", "4", "3"]
+
+
+COROUTINES = (
+    "use asyncio\n"
+    "afn work(n: i) -> i:\n"
+    "    aw asyncio.sleep(0.01)\n"
+    "    ret n * 2\n"
+    "afn slow():\n"
+    "    aw asyncio.sleep(10)\n"
+    "cls Job:\n"
+    "    fn __init__(s, n: i):\n"
+    "        s.n = n\n"
+    "    afn go(s) -> i:\n"
+    "        r = aw work(s.n)\n"
+    "        ret r + 1\n"
+    "afn main():\n"
+    "    jobs = []\n"
+    "    for i ~ range(2000):\n"
+    "        jobs = jobs + [work(i)]\n"
+    "    done = aw asyncio.gather(jobs)\n"
+    "    out len(done)\n"
+    "    acc = 0\n"
+    "    for d ~ done:\n"
+    "        acc = acc + d\n"
+    "    out acc\n"
+    "    out aw Job(4).go()\n"
+    "    out aw asyncio.timeout(slow(), 0.01)\n"
+    "    task = asyncio.spawn(work(21))\n"
+    "    total = 0\n"
+    "    while total < 3:\n"
+    "        step = aw work(1)\n"
+    "        total = total + step\n"
+    "    out aw task\n"
+    "    ret total\n"
+    "out work(1)\n"
+    "out asyncio.run(main())\n"
+)
+
+
+@pytest.mark.parametrize("engine", ["vm", "tree"])
+def test_coroutines_share_one_event_loop(engine: str) -> None:
+    # 2000 concurrent 10ms sleeps only finish quickly when they overlap.
+    assert _capture_output(COROUTINES, engine).split() == [
+        "<coroutine", "work>", "2000", "3998000", "9", "None", "42", "4"
+    ]
+
+
+@pytest.mark.parametrize("engine", ["vm", "tree"])
+def test_coroutine_can_only_be_awaited_once(engine: str) -> None:
+    src = (
+        "use asyncio: run\n"
+        "afn one() -> i:\n"
+        "    ret 1\n"
+        "afn twice(c):\n"
+        "    aw c\n"
+        "    aw c\n"
+        "run(twice(one()))\n"
+    )
+    with pytest.raises(RuntimeErrorBoa, match="already awaited"):
+        run_source(src, engine)
+